@@ -4,9 +4,12 @@
  * @date 05.01.2023
  */
 
+#pragma once
+
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <memory>
@@ -15,151 +18,56 @@
 #include <utility>
 #include <vector>
 
-const int kSizeOfArrays = 20;
-
-struct PositionOfBounds {
-  PositionOfBounds() = default;
-
-  PositionOfBounds(int row, int column, bool side)
-      : row{row}, column{column}, side{side} {}
-
-  PositionOfBounds(const PositionOfBounds& other) = default;
-
-  PositionOfBounds& operator=(const PositionOfBounds& other) {
-    row = other.row;
-    column = other.column;
-    side = other.side;
-    return *this;
-  }
-
-  PositionOfBounds& operator+=(int range) {
-    if (side) {
-      if (range < kSizeOfArrays - column) {
-        column += range;
-      } else {
-        range -= kSizeOfArrays - column;
-        ++row;
-        row += range / kSizeOfArrays;
-        final_shift(range, false, true);
-      }
-    } else {
-      if (range <= column) {
-        column -= range;
-      } else {
-        range -= column + 1;
-        ++row;
-        row += range / kSizeOfArrays;
-        final_shift(range, true, true);
-      }
-    }
-    return *this;
-  }
-
-  PositionOfBounds& operator-=(int range) {
-    if (side) {
-      if (range <= column) {
-        column -= range;
-      } else {
-        range -= column + 1;
-        --row;
-        row -= range / kSizeOfArrays;
-        final_shift(range, true, false);
-      }
-    } else {
-      if (range < kSizeOfArrays - column) {
-        column += range;
-      } else {
-        range -= kSizeOfArrays - column;
-        --row;
-        row -= range / kSizeOfArrays;
-        final_shift(range, false, false);
-      }
-    }
-    return *this;
-  }
-
-  void final_shift(int range, bool flag = true, bool second_flag = true) {
-    if ((static_cast<int>((range / kSizeOfArrays) % 2 == 0) ^
-         static_cast<int>(flag)) != 0) {
-      column = kSizeOfArrays - 1;
-      side = true ^ second_flag;
-      column -= range % kSizeOfArrays;
-    } else {
-      column = 0;
-      side = false ^ second_flag;
-      column += range % kSizeOfArrays;
-    }
-  }
-
-  ptrdiff_t operator-(const PositionOfBounds& other) const {
-    ptrdiff_t res = 0;
-    if (row > other.row) {
-      res += kSizeOfArrays * (row - other.row - 1);
-      if (side) {
-        res += column;
-      } else {
-        res += kSizeOfArrays - column - 1;
-      }
-      if (other.side) {
-        res += kSizeOfArrays - other.column;
-      } else {
-        res += other.column + 1;
-      }
-    } else if (row == other.row) {
-      if (column >= other.column) {
-        res += column - other.column;
-      } else {
-        return -1;
-      }
-    } else {
-      return -1;
-    }
-    return res;
-  }
-
-  bool operator==(const PositionOfBounds& other) const {
-    return row == other.row && column == other.column && side == other.side;
-  }
-
-  bool operator!=(const PositionOfBounds& other) const {
-    return !operator==(other);
-  }
-
-  PositionOfBounds get_next_element(bool flag = true) const {
-    PositionOfBounds result = *this;
-    if (flag) {
-      result += 1;
-    } else {
-      result.side = !result.side;
-      result -= 1;
-      result.side = !result.side;
-    }
-    return result;
-  }
+const size_t kDequeBlockBytes = 4096;
 
-  PositionOfBounds get_prev_element(bool flag = true) const {
-    PositionOfBounds result = *this;
-    if (flag) {
-      result -= 1;
-    } else {
-      result.side = !result.side;
-      result += 1;
-      result.side = !result.side;
-    }
-    return result;
+// Elements per block: the largest power of two that keeps a block within
+// kDequeBlockBytes, but never fewer than 16 so that large elements still
+// amortize the map. A power of two turns iterator index arithmetic into
+// shifts. Specialize to tune a type.
+template <typename T>
+struct DequeBlockSize {
+  static constexpr size_t fit(size_t count) {
+    return count * 2 * sizeof(T) <= kDequeBlockBytes ? fit(count * 2) : count;
   }
 
-  int row = 0;
-  int column = 0;
-  bool side = false;
+  static const size_t value = fit(16);
 };
 
-template <typename T, typename Allocator = std::allocator<T>>
+template <typename T, typename Allocator = std::allocator<T>,
+          size_t BlockSize = DequeBlockSize<T>::value>
 class Deque {
   using allocator_traits = std::allocator_traits<Allocator>;
   using allocator_for_vector =
       typename std::allocator_traits<Allocator>::template rebind_alloc<T*>;
 
+  template <typename Iter>
+  using RequireInputIterator = typename std::enable_if<std::is_convertible<
+      typename std::iterator_traits<Iter>::iterator_category,
+      std::input_iterator_tag>::value>::type;
+
+  // Iterators known to walk contiguous storage: pointers (which is also
+  // what std::array uses) and std::vector iterators. C++17 has no way to
+  // ask an arbitrary iterator.
+  template <typename Iter>
+  using is_contiguous_iterator = std::integral_constant<
+      bool,
+      std::is_pointer<Iter>::value ||
+          std::is_same<Iter, typename std::vector<T>::iterator>::value ||
+          std::is_same<Iter, typename std::vector<T>::const_iterator>::value>;
+
+  // Contiguous ranges of a trivially copyable T are copied with memcpy a
+  // block at a time. Proxy references (std::vector<bool>) do not qualify.
+  template <typename Iter>
+  using referenced_type = typename std::remove_cv<
+      typename std::remove_reference<
+          typename std::iterator_traits<Iter>::reference>::type>::type;
+
+  template <typename Iter>
+  using is_bitwise_copyable = std::integral_constant<
+      bool, is_contiguous_iterator<Iter>::value &&
+                std::is_trivially_copyable<T>::value &&
+                std::is_same<referenced_type<Iter>, T>::value>;
+
  public:
   template <bool IsConst>
   class base_iterator;
@@ -233,25 +141,31 @@ class Deque {
   Deque(Deque&& other)
       : begin_{other.begin_}, end_{other.end_}, size_{other.size_} {
     main_array_ = std::move(other.main_array_);
+    pool_ = std::move(other.pool_);
     alloc_ = std::move(other.alloc_);
     other.size_ = 0;
-    other.begin_ = PositionOfBounds();
-    other.end_ = PositionOfBounds();
+    other.begin_ = 0;
+    other.end_ = 0;
   }
 
   Deque(std::initializer_list<T> init, const Allocator& alloc = Allocator())
       : alloc_{alloc}, main_array_{alloc} {
-    auto iter = init.begin();
-    size_t i_index = 0;
     try {
-      for (; i_index < init.size(); ++i_index) {
-        push_back(*iter);
-        ++iter;
-      }
+      append_n(init.begin(), init.size());
     } catch (...) {
-      for (size_t j = 0; j < i_index; ++j) {
-        pop_back();
-      }
+      free_mem(0);
+      throw;
+    }
+  }
+
+  template <typename InputIt, typename = RequireInputIterator<InputIt>>
+  Deque(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+      : alloc_{alloc}, main_array_{alloc} {
+    try {
+      append_iter(first, last,
+                  typename std::iterator_traits<InputIt>::iterator_category());
+    } catch (...) {
+      free_mem(0);
       throw;
     }
   }
@@ -264,32 +178,35 @@ class Deque {
     for (size_t i = 0; i < copy_size; ++i) {
       pop_back();
     }
-    for (auto& iter : main_array_) {
-      allocator_traits::deallocate(alloc_, iter, kSizeOfArrays);
-    }
+    clear_main_array(main_array_, 0, main_array_.size());
+    clear_pool();
   }
 
   void swap(Deque& first, Deque& second) {
     std::swap(first.main_array_, second.main_array_);
+    std::swap(first.pool_, second.pool_);
     std::swap(first.alloc_, second.alloc_);
     std::swap(first.begin_, second.begin_);
     std::swap(first.end_, second.end_);
     std::swap(first.size_, second.size_);
   }
 
-  Deque<T, Allocator>& operator=(const Deque& other) {
+  Deque& operator=(const Deque& other) {
     auto alloc_copy = alloc_;
     auto begin_copy = begin_;
     auto end_copy = end_;
     auto size_copy = size_;
     auto main_array_copy = main_array_;
+    auto pool_copy = std::move(pool_);
+    pool_.clear();
     if (allocator_traits::propagate_on_container_copy_assignment::value &&
         alloc_ != other.alloc_) {
       alloc_ = other.alloc_;
       main_array_ = std::vector<T*, allocator_for_vector>(other.alloc_);
+      pool_ = std::vector<T*, allocator_for_vector>(other.alloc_);
     }
-    begin_ = PositionOfBounds();
-    end_ = PositionOfBounds();
+    begin_ = 0;
+    end_ = 0;
     main_array_.clear();
     main_array_.shrink_to_fit();
     size_ = 0;
@@ -303,14 +220,17 @@ class Deque {
         pop_back();
       }
       clear_main_array(main_array_, 0, main_array_.size());
+      clear_pool();
       std::swap(alloc_, alloc_copy);
       std::swap(begin_, begin_copy);
       std::swap(end_, end_copy);
       std::swap(size_, size_copy);
       std::swap(main_array_, main_array_copy);
+      std::swap(pool_, pool_copy);
       throw;
     }
-    Deque interm(alloc_copy, main_array_copy, begin_copy, end_copy, size_copy);
+    Deque interm(alloc_copy, main_array_copy, pool_copy, begin_copy, end_copy,
+                 size_copy);
     return *this;
   }
 
@@ -320,13 +240,42 @@ class Deque {
     return *this;
   }
 
+  void assign(size_t count, const T& value) {
+    clear();
+    reserve_slots(0, count);
+    for (size_t i = 0; i < count; ++i) {
+      push_back(value);
+    }
+  }
+
+  template <typename InputIt, typename = RequireInputIterator<InputIt>>
+  void assign(InputIt first, InputIt last) {
+    clear();
+    append_iter(first, last,
+                typename std::iterator_traits<InputIt>::iterator_category());
+  }
+
+  void assign(std::initializer_list<T> init) {
+    clear();
+    append_n(init.begin(), init.size());
+  }
+
+  // Destroys the elements; the blocks stay in the pool for later pushes.
+  void clear() {
+    while (size_ != 0) {
+      pop_back();
+    }
+  }
+
   size_t size() const { return size_; }
 
   bool empty() const { return !static_cast<bool>(size()); }
 
-  T& operator[](int32_t position) { return *(begin() + position); }
+  T& operator[](size_t position) { return *pointer_at(begin_ + position); }
 
-  const T& operator[](int32_t position) const { return *(begin() + position); }
+  const T& operator[](size_t position) const {
+    return *pointer_at(begin_ + position);
+  }
 
   T& at(size_t position) {
     if (position >= size()) {
@@ -343,72 +292,97 @@ class Deque {
   }
 
   void push_back(T&& value) {
-    check_for_pushes();
-    allocator_traits::construct(alloc_, get_pointer_on_position(end_),
-                                std::move(value));
-    end_ = end_.get_next_element();
+    check_for_pushes(false);
+    allocator_traits::construct(alloc_, pointer_at(end_), std::move(value));
+    ++end_;
     ++size_;
   }
 
   void push_back(const T& value) {
-    check_for_pushes();
-    allocator_traits::construct(alloc_, get_pointer_on_position(end_), value);
-    end_ = end_.get_next_element();
+    check_for_pushes(false);
+    allocator_traits::construct(alloc_, pointer_at(end_), value);
+    ++end_;
     ++size_;
   }
 
   void push_back() {
-    check_for_pushes();
-    allocator_traits::construct(alloc_, get_pointer_on_position(end_));
-    end_ = end_.get_next_element();
+    check_for_pushes(false);
+    allocator_traits::construct(alloc_, pointer_at(end_));
+    ++end_;
     ++size_;
   }
 
   template <typename... Args>
   void emplace_back(Args&&... args) {
-    check_for_pushes();
-    allocator_traits::construct(alloc_, get_pointer_on_position(end_),
+    check_for_pushes(false);
+    allocator_traits::construct(alloc_, pointer_at(end_),
                                 std::forward<Args>(args)...);
-    end_ = end_.get_next_element();
+    ++end_;
     ++size_;
   }
 
   void pop_back() {
-    end_ = end_.get_prev_element();
-    allocator_traits::destroy(alloc_, get_pointer_on_position(end_));
+    --end_;
+    allocator_traits::destroy(alloc_, pointer_at(end_));
     --size_;
+    if (size_ == 0 || end_ % BlockSize == 0) {
+      release_block(end_ / BlockSize);
+    }
   }
 
   void push_front(const T& value) {
-    check_for_pushes();
-    allocator_traits::construct(alloc_, get_pointer_on_position(begin_), value);
-    begin_ = begin_.get_next_element(false);
+    check_for_pushes(true);
+    allocator_traits::construct(alloc_, pointer_at(begin_ - 1), value);
+    --begin_;
     ++size_;
   }
 
   void push_front(T&& value) {
-    check_for_pushes();
-    allocator_traits::construct(alloc_, get_pointer_on_position(begin_),
+    check_for_pushes(true);
+    allocator_traits::construct(alloc_, pointer_at(begin_ - 1),
                                 std::move(value));
-    begin_ = begin_.get_next_element(false);
+    --begin_;
     ++size_;
   }
 
   template <typename... Args>
   void emplace_front(Args&&... args) {
-    check_for_pushes();
-    allocator_traits::construct(alloc_, get_pointer_on_position(begin_),
+    check_for_pushes(true);
+    allocator_traits::construct(alloc_, pointer_at(begin_ - 1),
                                 std::forward<Args>(args)...);
-    begin_ = begin_.get_next_element(false);
+    --begin_;
     ++size_;
   }
 
+  // Bulk pushes reserve the map once and construct the elements a block at a
+  // time. If an element throws, the deque is left as it was.
+  template <typename Range>
+  void append_range(Range&& range) {
+    append_iter(std::begin(range), std::end(range),
+                typename std::iterator_traits<decltype(std::begin(
+                    range))>::iterator_category());
+  }
+
+  // The elements keep their order: the first one of range becomes front().
+  template <typename Range>
+  void prepend_range(Range&& range) {
+    prepend_iter(std::begin(range), std::end(range),
+                 typename std::iterator_traits<decltype(std::begin(
+                     range))>::iterator_category());
+  }
+
   void pop_front() {
-    begin_ = begin_.get_prev_element(false);
-    allocator_traits::destroy(alloc_, get_pointer_on_position(begin_));
+    allocator_traits::destroy(alloc_, pointer_at(begin_));
+    ++begin_;
     --size_;
+    if (size_ == 0 || begin_ % BlockSize == 0) {
+      release_block((begin_ - 1) / BlockSize);
+    }
   }
 
+  // Holds the map and the slot index of the element, so moving by any
+  // distance is one addition and dereferencing is one division by the
+  // block size. Valid until the map is reallocated by a push.
   template <bool IsConst>
   class base_iterator {
    public:
@@ -418,39 +392,29 @@ class Deque {
     using iterator_category = std::random_access_iterator_tag;
     using difference_type = std::ptrdiff_t;
 
-    base_iterator(PositionOfBounds position,
-                  typename std::conditional<IsConst, const Deque<T, Allocator>*,
-                                            Deque<T, Allocator>*>::type deque)
-        : deque_{deque}, position_{position} {}
-
-    base_iterator(const base_iterator& other)
-        : position_{other.get_position()}, deque_{other.get_deque()} {}
+    base_iterator(T* const* map, size_t slot) : map_{map}, slot_{slot} {}
 
     operator base_iterator<true>() const {
-      return const_iterator(position_, deque_);
+      return const_iterator(map_, slot_);
     }
 
-    base_iterator& operator=(const base_iterator& other) {
-      position_ = other.position_;
-      deque_ = other.deque_;
-      return *this;
+    reference operator*() const {
+      return map_[slot_ / BlockSize][slot_ % BlockSize];
     }
 
-    typename std::conditional<IsConst, const T&, T&>::type operator*() const {
-      return *deque_->get_pointer_on_position(position_);
-    }
+    pointer operator->() const { return &operator*(); }
 
-    typename std::conditional<IsConst, const T*, T*>::type operator->() const {
-      return deque_->get_pointer_on_position(position_);
+    reference operator[](difference_type range) const {
+      return *(*this + range);
     }
 
     base_iterator& operator++() {
-      position_ = position_.get_next_element();
+      ++slot_;
       return *this;
     }
 
     base_iterator& operator--() {
-      position_ = position_.get_prev_element();
+      --slot_;
       return *this;
     }
 
@@ -466,34 +430,39 @@ class Deque {
       return copy;
     }
 
-    base_iterator& operator+=(int range) {
-      position_ += range;
+    base_iterator& operator+=(difference_type range) {
+      slot_ += range;
       return *this;
     }
 
-    base_iterator& operator-=(int range) {
-      position_ -= range;
+    base_iterator& operator-=(difference_type range) {
+      slot_ -= range;
       return *this;
     }
 
-    base_iterator operator+(int range) const {
+    base_iterator operator+(difference_type range) const {
       base_iterator copy = *this;
       copy += range;
       return copy;
     }
 
-    base_iterator operator-(int range) const {
+    friend base_iterator operator+(difference_type range,
+                                   const base_iterator& iter) {
+      return iter + range;
+    }
+
+    base_iterator operator-(difference_type range) const {
       base_iterator copy = *this;
       copy -= range;
       return copy;
     }
 
     difference_type operator-(const base_iterator& other) const {
-      return position_ - other.position_;
+      return static_cast<difference_type>(slot_ - other.slot_);
     }
 
     bool operator<(const base_iterator& other) const {
-      return (*this - other) < 0;
+      return slot_ < other.slot_;
     }
 
     bool operator>(const base_iterator& other) const { return other < *this; }
@@ -507,25 +476,16 @@ class Deque {
     }
 
     bool operator==(const base_iterator& other) const {
-      return !operator<(other) && !operator>(other);
+      return slot_ == other.slot_;
     }
 
     bool operator!=(const base_iterator& other) const {
       return !operator==(other);
     }
 
-    typename std::conditional<IsConst, const Deque<T, Allocator>*,
-                              Deque<T, Allocator>*>::type
-    get_deque() const {
-      return deque_;
-    }
-
-    PositionOfBounds get_position() const { return position_; }
-
    private:
-    PositionOfBounds position_;
-    typename std::conditional<IsConst, const Deque<T, Allocator>*,
-                              Deque<T, Allocator>*>::type deque_;
+    T* const* map_;
+    size_t slot_;
   };
 
   using iterator = base_iterator<false>;
@@ -534,12 +494,12 @@ class Deque {
   using reverse_iterator = std::reverse_iterator<base_iterator<false>>;
   using const_reverse_iterator = std::reverse_iterator<base_iterator<true>>;
 
-  iterator begin() { return iterator(get_position_for_begin(), this); }
+  iterator begin() { return iterator(main_array_.data(), begin_); }
 
   const_iterator begin() const { return cbegin(); }
 
   const_iterator cbegin() const {
-    return const_iterator(get_position_for_begin(), this);
+    return const_iterator(main_array_.data(), begin_);
   }
 
   reverse_iterator rbegin() {
@@ -550,11 +510,13 @@ class Deque {
     return const_reverse_iterator(std::make_reverse_iterator(cend()));
   }
 
-  iterator end() { return iterator(end_, this); }
+  iterator end() { return iterator(main_array_.data(), end_); }
 
   const_iterator end() const { return cend(); }
 
-  const_iterator cend() const { return const_iterator(end_, this); }
+  const_iterator cend() const {
+    return const_iterator(main_array_.data(), end_);
+  }
 
   reverse_iterator rend() {
     return reverse_iterator(std::make_reverse_iterator(begin()));
@@ -564,133 +526,384 @@ class Deque {
     return const_reverse_iterator(std::make_reverse_iterator(cbegin()));
   }
 
-  void insert(iterator iter, const T& value) {
-    push_back(value);
-    if (iter != end() - 1) {
-      PositionOfBounds first_pos = end_.get_prev_element();
-      PositionOfBounds second_pos = first_pos.get_prev_element();
-      while (second_pos != iter.get_position().get_prev_element()) {
-        std::swap(*get_pointer_on_position(first_pos),
-                  *get_pointer_on_position(second_pos));
-        first_pos = second_pos;
-        second_pos = first_pos.get_prev_element();
-      }
+  iterator insert(iterator iter, const T& value) {
+    return emplace(iter, value);
+  }
+
+  iterator insert(iterator iter, T&& value) {
+    return emplace(iter, std::move(value));
+  }
+
+  // Only the elements between iter and the closer end are shifted.
+  template <typename... Args>
+  iterator emplace(iterator iter, Args&&... args) {
+    size_t index = iter - begin();
+    if (index == 0) {
+      emplace_front(std::forward<Args>(args)...);
+      return begin();
+    }
+    if (index == size_) {
+      emplace_back(std::forward<Args>(args)...);
+      return end() - 1;
+    }
+    T value(std::forward<Args>(args)...);
+    if (index < size_ / 2) {
+      push_front(std::move((*this)[0]));
+      move_slots(begin_ + 2, begin_ + index + 1, begin_ + 1);
+    } else {
+      push_back(std::move((*this)[size_ - 1]));
+      move_slots_backward(begin_ + index, end_ - 2, end_ - 1);
+    }
+    (*this)[index] = std::move(value);
+    return begin() + index;
+  }
+
+  // Adds the range to the closer end and rotates it into place, so only the
+  // elements on that side of iter are moved. Returns the first inserted.
+  template <typename InputIt, typename = RequireInputIterator<InputIt>>
+  iterator insert(iterator iter, InputIt first, InputIt last) {
+    size_t index = iter - begin();
+    size_t old_size = size_;
+    if (index < size_ / 2) {
+      prepend_iter(first, last,
+                   typename std::iterator_traits<InputIt>::iterator_category());
+      size_t count = size_ - old_size;
+      std::rotate(begin(), begin() + count, begin() + count + index);
+    } else {
+      append_iter(first, last,
+                  typename std::iterator_traits<InputIt>::iterator_category());
+      std::rotate(begin() + index, begin() + old_size, end());
     }
+    return begin() + index;
   }
 
-  void erase(iterator iter) {
-    PositionOfBounds first_pos = iter.get_position();
-    PositionOfBounds second_pos = first_pos.get_next_element();
-    while (second_pos != end().get_position()) {
-      std::swap(*get_pointer_on_position(first_pos),
-                *get_pointer_on_position(second_pos));
-      first_pos = second_pos;
-      second_pos = first_pos.get_next_element();
+  iterator erase(iterator iter) { return erase(iter, iter + 1); }
+
+  // Closes the gap from the side with fewer elements.
+  iterator erase(iterator first, iterator last) {
+    if (first == last) {
+      return first;
+    }
+    size_t index = first - begin();
+    size_t count = last - first;
+    if (index < size_ - index - count) {
+      move_slots_backward(begin_, begin_ + index, begin_ + index + count);
+      for (size_t i = 0; i < count; ++i) {
+        pop_front();
+      }
+    } else {
+      move_slots(begin_ + index + count, end_, begin_ + index);
+      for (size_t i = 0; i < count; ++i) {
+        pop_back();
+      }
     }
-    pop_back();
+    return begin() + index;
   }
 
+  // Returns the blocks kept for reuse to the allocator.
+  void shrink_to_fit() { clear_pool(); }
+
   Allocator get_allocator() { return alloc_; }
 
  private:
   Deque(Allocator& alloc, std::vector<T*, allocator_for_vector>& main_array,
-        PositionOfBounds begin, PositionOfBounds end, size_t size)
+        std::vector<T*, allocator_for_vector>& pool, size_t begin, size_t end,
+        size_t size)
       : alloc_{alloc},
         main_array_{main_array},
+        pool_{std::move(pool)},
         begin_{begin},
         end_{end},
         size_{size} {}
 
-  void check_for_pushes() {
+  // Makes sure the slot the next push_front (front) or push_back writes to
+  // exists and has a block; blocks are allocated only when a push reaches
+  // them.
+  void check_for_pushes(bool front) {
+    reserve_slots(front ? 1 : 0, front ? 0 : 1);
+    T*& block = main_array_[(front ? begin_ - 1 : end_) / BlockSize];
+    if (block == nullptr) {
+      block = acquire_block();
+    }
+  }
+
+  // Makes room in the map for front more elements before begin_ and back
+  // more after end_; their blocks are still allocated lazily.
+  void reserve_slots(size_t front, size_t back) {
     if (!is_mem_alloced()) {
       allocate_mem(2);
     }
-    if (is_full()) {
-      reallocation();
+    if (begin_ < front || main_array_.size() * BlockSize - end_ < back) {
+      reallocation(front, back);
+    }
+  }
+
+  // Constructs count elements of the range at place, which all lie in one
+  // block. Destroys what was constructed if an element throws.
+  template <typename Iter>
+  Iter construct_chunk(T* place, Iter first, size_t count) {
+    if constexpr (is_bitwise_copyable<Iter>::value) {
+      std::memcpy(place, std::addressof(*first), count * sizeof(T));
+      return first + count;
+    } else {
+      size_t i_idx = 0;
+      try {
+        for (; i_idx < count; ++i_idx, ++first) {
+          allocator_traits::construct(alloc_, place + i_idx, *first);
+        }
+      } catch (...) {
+        for (size_t j = 0; j < i_idx; ++j) {
+          allocator_traits::destroy(alloc_, place + j);
+        }
+        throw;
+      }
+      return first;
     }
   }
 
-  PositionOfBounds get_position_for_begin() const {
-    PositionOfBounds position = begin_;
-    position.side = !position.side;
+  template <typename Iter>
+  void append_n(Iter first, size_t count) {
+    if (count == 0) {
+      return;
+    }
+    reserve_slots(0, count);
+    size_t old_size = size_;
+    try {
+      while (count != 0) {
+        T*& block = main_array_[end_ / BlockSize];
+        if (block == nullptr) {
+          block = acquire_block();
+        }
+        size_t chunk = std::min(count, BlockSize - end_ % BlockSize);
+        first = construct_chunk(block + end_ % BlockSize, first, chunk);
+        end_ += chunk;
+        size_ += chunk;
+        count -= chunk;
+      }
+    } catch (...) {
+      while (size_ != old_size) {
+        pop_back();
+      }
+      if ((size_ == 0 || end_ % BlockSize == 0) &&
+          main_array_[end_ / BlockSize] != nullptr) {
+        release_block(end_ / BlockSize);
+      }
+      throw;
+    }
+  }
+
+  // The new elements are constructed in front of begin_ and only become
+  // part of the deque once all of them are in place.
+  template <typename Iter>
+  void prepend_n(Iter first, size_t count) {
+    if (count == 0) {
+      return;
+    }
     if (size_ == 0) {
-      return position;
+      append_n(first, count);
+      return;
     }
-    return position.get_next_element();
+    reserve_slots(count, 0);
+    size_t new_begin = begin_ - count;
+    size_t slot = new_begin;
+    try {
+      while (slot != begin_) {
+        T*& block = main_array_[slot / BlockSize];
+        if (block == nullptr) {
+          block = acquire_block();
+        }
+        size_t chunk = std::min(begin_ - slot, BlockSize - slot % BlockSize);
+        first = construct_chunk(block + slot % BlockSize, first, chunk);
+        slot += chunk;
+      }
+    } catch (...) {
+      for (size_t i = new_begin; i < slot; ++i) {
+        allocator_traits::destroy(alloc_, pointer_at(i));
+      }
+      for (size_t j = new_begin / BlockSize; j < begin_ / BlockSize; ++j) {
+        if (main_array_[j] != nullptr) {
+          release_block(j);
+        }
+      }
+      throw;
+    }
+    begin_ = new_begin;
+    size_ += count;
   }
 
-  void free_mem(size_t position) {
-    size_t counter = 0;
-    for (size_t i = 0; i < position; ++i) {
-      pop_back();
+  template <typename Iter>
+  void append_iter(Iter first, Iter last, std::forward_iterator_tag) {
+    append_n(first, static_cast<size_t>(std::distance(first, last)));
+  }
+
+  // Single-pass ranges cannot be measured in advance, so they are pushed
+  // one by one.
+  template <typename Iter>
+  void append_iter(Iter first, Iter last, std::input_iterator_tag) {
+    size_t old_size = size_;
+    try {
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+    } catch (...) {
+      while (size_ != old_size) {
+        pop_back();
+      }
+      throw;
     }
-    clear_main_array(main_array_, 0, main_array_.size());
   }
 
-  T* get_pointer_on_position(PositionOfBounds position) {
-    return main_array_[position.row + main_array_.size() / 2] + position.column;
+  template <typename Iter>
+  void prepend_iter(Iter first, Iter last, std::forward_iterator_tag) {
+    prepend_n(first, static_cast<size_t>(std::distance(first, last)));
   }
 
-  const T* get_pointer_on_position(PositionOfBounds position) const {
-    return main_array_[position.row + main_array_.size() / 2] + position.column;
+  template <typename Iter>
+  void prepend_iter(Iter first, Iter last, std::input_iterator_tag) {
+    size_t old_size = size_;
+    append_iter(first, last, std::input_iterator_tag());
+    std::rotate(begin(), begin() + old_size, end());
   }
 
-  bool is_mem_alloced() const {
-    return static_cast<bool>(main_array_.capacity());
+  // std::move of the elements in slots [from, to) to the slots starting at
+  // dest, done one contiguous run at a time so that trivially copyable
+  // elements are moved with memmove.
+  void move_slots(size_t from, size_t to, size_t dest) {
+    while (from != to) {
+      size_t chunk = std::min({to - from, BlockSize - from % BlockSize,
+                               BlockSize - dest % BlockSize});
+      T* source = pointer_at(from);
+      std::move(source, source + chunk, pointer_at(dest));
+      from += chunk;
+      dest += chunk;
+    }
   }
 
-  void allocate_mem(size_t size) {
-    begin_ = PositionOfBounds(-1, 0, true);
-    end_ = PositionOfBounds(0, 0, true);
-    main_array_.resize(size);
-    allocate_part(main_array_, 0, main_array_.size());
+  // std::move_backward counterpart of move_slots; dest_end is the slot after
+  // the last destination.
+  void move_slots_backward(size_t from, size_t to, size_t dest_end) {
+    while (from != to) {
+      size_t chunk = std::min({to - from, (to - 1) % BlockSize + 1,
+                               (dest_end - 1) % BlockSize + 1});
+      T* source = pointer_at(to - chunk);
+      std::move_backward(source, source + chunk,
+                         pointer_at(dest_end - chunk) + chunk);
+      to -= chunk;
+      dest_end -= chunk;
+    }
+  }
+
+  // Blocks emptied by pops wait in pool_ for the next push instead of going
+  // back to the allocator. A block is only ever in the map or in the pool,
+  // so the pool never outgrows the map and its capacity is reserved
+  // together with the map; releasing a block therefore cannot throw.
+  T* acquire_block() {
+    if (pool_.empty()) {
+      return allocator_traits::allocate(alloc_, BlockSize);
+    }
+    T* block = pool_.back();
+    pool_.pop_back();
+    return block;
   }
 
-  bool is_full() const { return front_overflow() || back_overflow(); }
+  void release_block(size_t index) {
+    pool_.push_back(main_array_[index]);
+    main_array_[index] = nullptr;
+  }
+
+  void clear_pool() {
+    for (T* block : pool_) {
+      allocator_traits::deallocate(alloc_, block, BlockSize);
+    }
+    pool_.clear();
+  }
 
-  bool front_overflow() const {
-    return (begin_.row + static_cast<int>(main_array_.size()) / 2) < 0;
+  void free_mem(size_t position) {
+    for (size_t i = 0; i < position; ++i) {
+      pop_back();
+    }
+    clear_main_array(main_array_, 0, main_array_.size());
+    clear_pool();
   }
 
-  bool back_overflow() const {
-    return (end_.row + static_cast<int>(main_array_.size() / 2)) >=
-           static_cast<int>(main_array_.size());
+  T* pointer_at(size_t slot) {
+    return main_array_[slot / BlockSize] + slot % BlockSize;
   }
 
-  void reallocation() {
-    std::vector<T*, allocator_for_vector> new_array(
-        main_array_.size() * 2, main_array_.get_allocator());
-    size_t begin_of_data = new_array.size() / 2 - main_array_.size() / 2;
-    std::copy(main_array_.begin(), main_array_.end(),
-              new_array.begin() + begin_of_data);
-    allocate_part(new_array, 0, begin_of_data);
-    allocate_part(new_array, begin_of_data + main_array_.size(),
-                  new_array.size());
-    main_array_ = new_array;
+  const T* pointer_at(size_t slot) const {
+    return main_array_[slot / BlockSize] + slot % BlockSize;
   }
 
-  void allocate_part(std::vector<T*, allocator_for_vector>& array, size_t begin,
-                     size_t end) {
-    try {
-      for (; begin < end; ++begin) {
-        array[begin] = allocator_traits::allocate(alloc_, kSizeOfArrays);
+  bool is_mem_alloced() const {
+    return static_cast<bool>(main_array_.capacity());
+  }
+
+  void allocate_mem(size_t size) {
+    pool_.reserve(size);
+    main_array_.resize(size);
+    begin_ = size / 2 * BlockSize;
+    end_ = begin_;
+  }
+
+  // Moves the blocks between begin_ and end_ to the middle of the map,
+  // leaving room for front_slots more elements before them and back_slots
+  // after. The map only doubles when those blocks take more than half of it,
+  // so a deque used as a one-ended queue keeps sliding through a map of
+  // constant size. Only block pointers move; elements stay where they are.
+  void reallocation(size_t front_slots, size_t back_slots) {
+    size_t first_block = begin_ / BlockSize;
+    size_t used = end_ / BlockSize - first_block + 1;
+    size_t front_blocks = (front_slots + BlockSize - 1) / BlockSize;
+    size_t back_blocks = (back_slots + BlockSize - 1) / BlockSize;
+    size_t needed = front_blocks + used + back_blocks;
+    size_t new_size = main_array_.size();
+    while (needed * 2 > new_size) {
+      new_size *= 2;
+    }
+    size_t new_first_block = front_blocks + (new_size - needed) / 2;
+    if (new_size == main_array_.size()) {
+      if (new_first_block > first_block) {
+        std::rotate(main_array_.begin(),
+                    main_array_.end() - (new_first_block - first_block),
+                    main_array_.end());
+      } else {
+        std::rotate(main_array_.begin(),
+                    main_array_.begin() + (first_block - new_first_block),
+                    main_array_.end());
       }
-    } catch (...) {
-      clear_main_array(array, 0, begin);
-      throw;
+    } else {
+      std::vector<T*, allocator_for_vector> new_array(
+          new_size, nullptr, main_array_.get_allocator());
+      pool_.reserve(new_size);
+      size_t last_block = std::min(first_block + used, main_array_.size());
+      std::copy(main_array_.begin() + first_block,
+                main_array_.begin() + last_block,
+                new_array.begin() + new_first_block);
+      // Blocks left outside the used range by a failed push are not lost.
+      for (size_t j = 0; j < main_array_.size(); ++j) {
+        if ((j < first_block || j >= last_block) && main_array_[j] != nullptr) {
+          pool_.push_back(main_array_[j]);
+        }
+      }
+      main_array_.swap(new_array);
     }
+    begin_ = begin_ - first_block * BlockSize + new_first_block * BlockSize;
+    end_ = end_ - first_block * BlockSize + new_first_block * BlockSize;
   }
 
   void clear_main_array(std::vector<T*, allocator_for_vector>& array,
                         size_t begin, size_t end) {
     for (size_t j = begin; j < end; ++j) {
-      allocator_traits::deallocate(alloc_, array[j], kSizeOfArrays);
+      if (array[j] != nullptr) {
+        allocator_traits::deallocate(alloc_, array[j], BlockSize);
+      }
     }
   }
 
   Allocator alloc_;
   std::vector<T*, allocator_for_vector> main_array_;
-  PositionOfBounds begin_;
-  PositionOfBounds end_;
+  std::vector<T*, allocator_for_vector> pool_{alloc_};
+  size_t begin_ = 0;
+  size_t end_ = 0;
   size_t size_ = 0;
 };
\ No newline at end of file
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bounded lock-free queues for handing elements between threads. The
+// capacity is rounded up to a power of two and fixed at construction; a push
+// into a full queue or a pop from an empty one fails instead of waiting.
+// The producer and consumer indices live on separate cache lines so that the
+// two sides do not invalidate each other's line on every operation.
+const size_t kCacheLineSize = 64;
+
+inline size_t RingBufferCapacity(size_t capacity) {
+  size_t res = 1;
+  while (res < capacity) {
+    res *= 2;
+  }
+  return res;
+}
+
+// One producer thread, one consumer thread. Each side keeps a private copy
+// of the other side's index and rereads the shared one only when the copy
+// says the queue is full (empty), so the common case touches one shared
+// cache line.
+template <typename T, typename Allocator = std::allocator<T>>
+class SpscRingBuffer {
+  using allocator_traits = std::allocator_traits<Allocator>;
+
+ public:
+  explicit SpscRingBuffer(size_t capacity, const Allocator& alloc = Allocator())
+      : alloc_{alloc}, mask_{RingBufferCapacity(capacity) - 1} {
+    buffer_ = allocator_traits::allocate(alloc_, mask_ + 1);
+  }
+
+  SpscRingBuffer(const SpscRingBuffer&) = delete;
+
+  SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+  ~SpscRingBuffer() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i) {
+      allocator_traits::destroy(alloc_, buffer_ + (i & mask_));
+    }
+    allocator_traits::deallocate(alloc_, buffer_, mask_ + 1);
+  }
+
+  // Producer side.
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ > mask_) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ > mask_) {
+        return false;
+      }
+    }
+    allocator_traits::construct(alloc_, buffer_ + (tail & mask_),
+                                std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_push(const T& value) { return try_emplace(value); }
+
+  bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+  // Consumer side. If moving into value throws, the element stays queued.
+  bool try_pop(T& value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) {
+        return false;
+      }
+    }
+    T* element = buffer_ + (head & mask_);
+    value = std::move(*element);
+    allocator_traits::destroy(alloc_, element);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Exact only while neither side is running.
+  size_t size() const {
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  Allocator get_allocator() const { return alloc_; }
+
+ private:
+  Allocator alloc_;
+  T* buffer_ = nullptr;
+  size_t mask_;
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  size_t tail_cache_ = 0;
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+  size_t head_cache_ = 0;
+};
+
+// Any number of producers and consumers (D. Vyukov's bounded queue). Every
+// cell carries a sequence number telling whether it is ready for the push or
+// the pop of the current lap, so a thread claims a cell with one CAS on the
+// shared index and never waits for another thread to finish its copy.
+//
+// A claimed cell must be filled and emptied without throwing, or the threads
+// of the next lap would wait for it forever: elements whose constructor may
+// throw are built before a cell is claimed and moved in, and T has to be
+// nothrow movable.
+template <typename T, typename Allocator = std::allocator<T>>
+class MpmcRingBuffer {
+  static_assert(std::is_nothrow_move_constructible<T>::value &&
+                    std::is_nothrow_move_assignable<T>::value,
+                "MpmcRingBuffer requires nothrow move operations");
+
+  using allocator_traits = std::allocator_traits<Allocator>;
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  using cell_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Cell>;
+  using cell_allocator_traits = std::allocator_traits<cell_allocator>;
+
+ public:
+  explicit MpmcRingBuffer(size_t capacity, const Allocator& alloc = Allocator())
+      : alloc_{alloc}, mask_{RingBufferCapacity(capacity) - 1} {
+    cell_allocator cell_alloc(alloc_);
+    cells_ = cell_allocator_traits::allocate(cell_alloc, mask_ + 1);
+    for (size_t i = 0; i <= mask_; ++i) {
+      new (cells_ + i) Cell;
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+
+  MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+  ~MpmcRingBuffer() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i) {
+      allocator_traits::destroy(alloc_, element(cells_[i & mask_]));
+    }
+    cell_allocator cell_alloc(alloc_);
+    cell_allocator_traits::deallocate(cell_alloc, cells_, mask_ + 1);
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args) {
+    if constexpr (std::is_nothrow_constructible<T, Args...>::value) {
+      Cell* cell = claim_for_push();
+      if (cell == nullptr) {
+        return false;
+      }
+      allocator_traits::construct(alloc_, element(*cell),
+                                  std::forward<Args>(args)...);
+      publish_push(*cell);
+      return true;
+    } else {
+      T value(std::forward<Args>(args)...);
+      return try_emplace(std::move(value));
+    }
+  }
+
+  bool try_push(const T& value) { return try_emplace(value); }
+
+  bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+  bool try_pop(T& value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[head & mask_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      auto lag = static_cast<std::ptrdiff_t>(sequence - (head + 1));
+      if (lag == 0) {
+        if (head_.compare_exchange_weak(head, head + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (lag < 0) {
+        return false;
+      } else {
+        head = head_.load(std::memory_order_relaxed);
+      }
+    }
+    T* elem = element(*cell);
+    value = std::move(*elem);
+    allocator_traits::destroy(alloc_, elem);
+    cell->sequence.store(head + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Exact only while no thread is pushing or popping.
+  size_t size() const {
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  Allocator get_allocator() const { return alloc_; }
+
+ private:
+  static T* element(Cell& cell) { return reinterpret_cast<T*>(cell.storage); }
+
+  Cell* claim_for_push() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell* cell = &cells_[tail & mask_];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      auto lag = static_cast<std::ptrdiff_t>(sequence - tail);
+      if (lag == 0) {
+        if (tail_.compare_exchange_weak(tail, tail + 1,
+                                        std::memory_order_relaxed)) {
+          return cell;
+        }
+      } else if (lag < 0) {
+        return nullptr;
+      } else {
+        tail = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // The cell at index tail now holds an element: its sequence becomes
+  // tail + 1, which is what the pop of the same lap waits for.
+  void publish_push(Cell& cell) {
+    cell.sequence.store(cell.sequence.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+  }
+
+  Allocator alloc_;
+  Cell* cells_ = nullptr;
+  size_t mask_;
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+};
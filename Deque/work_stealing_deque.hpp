@@ -0,0 +1,224 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "deque.hpp"
+#include "ring_buffer.hpp"
+
+// Chase-Lev work-stealing deque (in the C11 formulation of Le et al.): the
+// owner thread pushes and pops at the back, any number of thieves steal from
+// the front. Elements are copied out by value and read racily before the
+// steal is confirmed, so T must be trivially copyable (e.g. a task pointer).
+//
+// Storage is a power-of-two map of blocks, as in Deque, used as a ring:
+// index i lives in block (i / BlockSize) mod map size. Growing doubles the
+// map and copies only block pointers; the blocks themselves never move and
+// are never written at another index while a thief may still read them
+// through an older map, because the owner grows as soon as the back would
+// reach the block of the front. Old maps are kept on a list until the deque
+// is destroyed. They only hold pointers, so together they are smaller than
+// the current map.
+template <typename T, typename Allocator = std::allocator<T>,
+          size_t BlockSize = DequeBlockSize<T>::value>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "WorkStealingDeque requires a trivially copyable T");
+
+  using slot = std::atomic<T>;
+  using slot_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<slot>;
+  using slot_allocator_traits = std::allocator_traits<slot_allocator>;
+  using pointer_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<slot*>;
+
+  struct Map {
+    Map(size_t size, Map* previous, const Allocator& alloc)
+        : blocks(size, nullptr, pointer_allocator(alloc)), previous{previous} {}
+
+    slot& at(std::ptrdiff_t index) {
+      size_t block = static_cast<size_t>(index) / BlockSize;
+      return blocks[block & (blocks.size() - 1)]
+                   [static_cast<size_t>(index) % BlockSize];
+    }
+
+    std::vector<slot*, pointer_allocator> blocks;
+    Map* previous;
+  };
+
+  using map_allocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Map>;
+  using map_allocator_traits = std::allocator_traits<map_allocator>;
+
+ public:
+  explicit WorkStealingDeque(const Allocator& alloc = Allocator())
+      : alloc_{alloc} {
+    Map* map = create_map(2, nullptr);
+    try {
+      for (slot*& block : map->blocks) {
+        block = allocate_block();
+      }
+    } catch (...) {
+      destroy_map(map, true);
+      throw;
+    }
+    map_.store(map, std::memory_order_relaxed);
+  }
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  ~WorkStealingDeque() {
+    Map* map = map_.load(std::memory_order_relaxed);
+    destroy_map(map, true);
+  }
+
+  // Owner only.
+  void push_back(const T& value) {
+    std::ptrdiff_t bottom = bottom_.load(std::memory_order_relaxed);
+    std::ptrdiff_t top = top_.load(std::memory_order_acquire);
+    Map* map = map_.load(std::memory_order_relaxed);
+    if (static_cast<size_t>(bottom / BlockSize - top / BlockSize) >=
+        map->blocks.size()) {
+      map = grow(map, top);
+    }
+    map->at(bottom).store(value, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  // Owner only. Takes the most recently pushed element.
+  bool pop_back(T& value) {
+    std::ptrdiff_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Map* map = map_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::ptrdiff_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+    value = map->at(bottom).load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // The last element: race the thieves for it.
+      bool won = top_.compare_exchange_strong(top, top + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  // Any thread. Takes the oldest element; fails if the deque is empty or
+  // another thread took that element first.
+  bool steal(T& value) {
+    std::ptrdiff_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::ptrdiff_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return false;
+    }
+    Map* map = map_.load(std::memory_order_acquire);
+    T stolen = map->at(top).load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return false;
+    }
+    value = stolen;
+    return true;
+  }
+
+  // A snapshot; exact only while no thread is pushing, popping or stealing.
+  size_t size() const {
+    std::ptrdiff_t top = top_.load(std::memory_order_acquire);
+    std::ptrdiff_t bottom = bottom_.load(std::memory_order_acquire);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  Allocator get_allocator() const { return alloc_; }
+
+ private:
+  slot* allocate_block() {
+    slot_allocator slot_alloc(alloc_);
+    slot* block = slot_allocator_traits::allocate(slot_alloc, BlockSize);
+    for (size_t i = 0; i < BlockSize; ++i) {
+      slot_allocator_traits::construct(slot_alloc, block + i);
+    }
+    return block;
+  }
+
+  void deallocate_block(slot* block) {
+    slot_allocator slot_alloc(alloc_);
+    slot_allocator_traits::deallocate(slot_alloc, block, BlockSize);
+  }
+
+  Map* create_map(size_t size, Map* previous) {
+    map_allocator map_alloc(alloc_);
+    Map* map = map_allocator_traits::allocate(map_alloc, 1);
+    try {
+      map_allocator_traits::construct(map_alloc, map, size, previous, alloc_);
+    } catch (...) {
+      map_allocator_traits::deallocate(map_alloc, map, 1);
+      throw;
+    }
+    return map;
+  }
+
+  // Destroys map and the maps retired before it; with_blocks also frees the
+  // blocks of map, which include every block of the older maps.
+  void destroy_map(Map* map, bool with_blocks) {
+    if (with_blocks) {
+      for (slot* block : map->blocks) {
+        if (block != nullptr) {
+          deallocate_block(block);
+        }
+      }
+    }
+    map_allocator map_alloc(alloc_);
+    while (map != nullptr) {
+      Map* previous = map->previous;
+      map_allocator_traits::destroy(map_alloc, map);
+      map_allocator_traits::deallocate(map_alloc, map, 1);
+      map = previous;
+    }
+  }
+
+  // The blocks holding indices from top on keep their place in the ring of
+  // the doubled map; the other half of it gets fresh blocks.
+  Map* grow(Map* map, std::ptrdiff_t top) {
+    size_t size = map->blocks.size();
+    Map* bigger = create_map(size * 2, map);
+    size_t first = static_cast<size_t>(top) / BlockSize;
+    for (size_t j = first; j < first + size; ++j) {
+      bigger->blocks[j & (size * 2 - 1)] = map->blocks[j & (size - 1)];
+    }
+    size_t allocated = 0;
+    try {
+      for (size_t j = first + size; j < first + size * 2; ++j) {
+        bigger->blocks[j & (size * 2 - 1)] = allocate_block();
+        ++allocated;
+      }
+    } catch (...) {
+      for (size_t j = first + size; j < first + size + allocated; ++j) {
+        deallocate_block(bigger->blocks[j & (size * 2 - 1)]);
+      }
+      bigger->previous = nullptr;
+      destroy_map(bigger, false);
+      throw;
+    }
+    map_.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+  Allocator alloc_;
+  std::atomic<Map*> map_{nullptr};
+  alignas(kCacheLineSize) std::atomic<std::ptrdiff_t> top_{0};
+  alignas(kCacheLineSize) std::atomic<std::ptrdiff_t> bottom_{0};
+};
@@ -3,22 +3,52 @@
 #include <algorithm>
 #include <vector>
 
+#include "matrix_view.hpp"
+
+const size_t kStrassenThreshold = 128;
+
+template <typename T>
+struct MatrixMultiplier {
+  static void Multiply(const T* first, size_t first_stride, const T* second,
+                       size_t second_stride, T* res, size_t res_stride,
+                       size_t rows, size_t inner, size_t cols) {
+    for (size_t i = 0; i < rows; ++i) {
+      T* res_row = res + i * res_stride;
+      std::fill(res_row, res_row + cols, T());
+      for (size_t t_num = 0; t_num < inner; ++t_num) {
+        const T& elem = first[i * first_stride + t_num];
+        const T* second_row = second + t_num * second_stride;
+        for (size_t j = 0; j < cols; ++j) {
+          res_row[j] += elem * second_row[j];
+        }
+      }
+    }
+  }
+};
+
 template <size_t N, size_t M, typename T = int64_t>
 class Matrix {
  public:
-  Matrix() : table_(N, std::vector<T>(M)) {}
+  Matrix() : table_(N * M) {}
 
-  Matrix(const std::vector<std::vector<T>>& vector) : table_{vector} {}
+  Matrix(const std::vector<std::vector<T>>& vector) {
+    table_.reserve(N * M);
+    for (const auto& row : vector) {
+      table_.insert(table_.end(), row.begin(), row.end());
+    }
+  }
 
   Matrix(const Matrix& other) : table_{other.table_} {};
 
-  Matrix(const T& elem) : table_(N, std::vector<T>(M, elem)) {}
+  Matrix(const T& elem) : table_(N * M, elem) {}
+
+  explicit Matrix(MatrixView<T> view) : table_(N * M) {
+    CopyInto(view, Span());
+  }
 
   Matrix& operator+=(const Matrix& other) {
-    for (size_t i = 0; i < N; ++i) {
-      for (size_t j = 0; j < M; ++j) {
-        table_[i][j] += other.table_[i][j];
-      }
+    for (size_t i = 0; i < N * M; ++i) {
+      table_[i] += other.table_[i];
     }
     return *this;
   }
@@ -29,10 +59,8 @@ class Matrix {
   }
 
   Matrix& operator-=(const Matrix& other) {
-    for (size_t i = 0; i < N; ++i) {
-      for (size_t j = 0; j < M; ++j) {
-        table_[i][j] -= other(i, j);
-      }
+    for (size_t i = 0; i < N * M; ++i) {
+      table_[i] -= other.table_[i];
     }
     return *this;
   }
@@ -41,7 +69,7 @@ class Matrix {
     Matrix<M, N, T> res;
     for (size_t i = 0; i < M; ++i) {
       for (size_t j = 0; j < N; ++j) {
-        res(i, j) = table_[j][i];
+        res(i, j) = table_[j * M + i];
       }
     }
     return res;
@@ -49,7 +77,7 @@ class Matrix {
 
   T TraceReal(Matrix<N, N, T> mat) {
     T res = T();
-    for (size_t i = 0; i < table_.size(); ++i) {
+    for (size_t i = 0; i < N; ++i) {
       res += mat(i, i);
     }
     return res;
@@ -58,46 +86,212 @@ class Matrix {
   T Trace() { return TraceReal(*this); }
 
   T& operator()(const size_t& i_num, const size_t& j_num) {
-    return this->table_[i_num][j_num];
+    return this->table_[i_num * M + j_num];
   }
 
   const T& operator()(const size_t& i_num, const size_t& j_num) const {
-    return this->table_[i_num][j_num];
+    return this->table_[i_num * M + j_num];
   }
 
-  bool operator==(const Matrix& second) { return table_ = second.table_; }
+  bool operator==(const Matrix& second) const {
+    return table_ == second.table_;
+  }
 
   template <size_t K>
-  Matrix<N, K, T> operator*(const Matrix<M, K, T>& second) {
+  Matrix<N, K, T> operator*(const Matrix<M, K, T>& second) const {
     Matrix<N, K, T> res;
-    for (size_t j = 0; j < K; ++j) {
-      for (size_t t_num = 0; t_num < M; ++t_num) {
-        for (size_t i = 0; i < N; ++i) {
-          res.GetTable()[i][j] +=
-              table_[i][t_num] * second.GetTable()[t_num][j];
-        }
+    MultiplyInto(second, res);
+    return res;
+  }
+
+  Matrix<N, N, T> Pow(size_t power, bool use_strassen = true) const {
+    Matrix<N, N, T> base = *this;
+    Matrix<N, N, T> res = Identity();
+    Matrix<N, N, T> buffer;
+    std::vector<T> scratch;
+    use_strassen = use_strassen && N >= kStrassenThreshold;
+    while (power != 0) {
+      if ((power & 1) != 0) {
+        res.MultiplyInto(base, buffer, use_strassen, scratch);
+        res.Swap(buffer);
+      }
+      power >>= 1;
+      if (power != 0) {
+        base.MultiplyInto(base, buffer, use_strassen, scratch);
+        base.Swap(buffer);
       }
     }
     return res;
   }
 
+  static Matrix<N, N, T> Identity() {
+    Matrix<N, N, T> res;
+    for (size_t i = 0; i < N; ++i) {
+      res(i, i) = T(1);
+    }
+    return res;
+  }
+
+  void Swap(Matrix& other) { table_.swap(other.table_); }
+
   template <typename K>
-  Matrix<N, M, T> operator*(const K& elem) {
+  Matrix<N, M, T> operator*(const K& elem) const {
     Matrix<N, M, T> res = *this;
+    for (size_t i = 0; i < N * M; ++i) {
+      res.table_[i] *= elem;
+    }
+    return res;
+  }
+
+  // A nested copy of the flat storage. It is returned const so that code
+  // written against the old mutable reference, m.GetTable()[i][j] = x, fails
+  // to compile instead of silently writing to a temporary; use operator()
+  // or Span() to modify elements.
+  const std::vector<std::vector<T>> GetTable() const {
+    std::vector<std::vector<T>> res(N);
     for (size_t i = 0; i < N; ++i) {
-      for (size_t j = 0; j < M; ++j) {
-        res.table_[i][j] *= elem;
-      }
+      res[i].assign(table_.begin() + i * M, table_.begin() + (i + 1) * M);
     }
     return res;
   }
 
-  std::vector<std::vector<T>>& GetTable() { return table_; }
+  T* Data() { return table_.data(); }
 
-  const std::vector<std::vector<T>>& GetTable() const { return table_; }
+  const T* Data() const { return table_.data(); }
+
+  MatrixView<T> View() const { return MatrixView<T>(table_.data(), N, M); }
+
+  MatrixSpan<T> Span() { return MatrixSpan<T>(table_.data(), N, M); }
+
+  MatrixView<T> Block(size_t row, size_t col, size_t rows, size_t cols) const {
+    return View().Block(row, col, rows, cols);
+  }
+
+  MatrixSpan<T> Block(size_t row, size_t col, size_t rows, size_t cols) {
+    return Span().Block(row, col, rows, cols);
+  }
 
  private:
-  std::vector<std::vector<T>> table_;
+  template <size_t, size_t, typename>
+  friend class Matrix;
+
+  template <size_t K>
+  void MultiplyInto(const Matrix<M, K, T>& second, Matrix<N, K, T>& res) const {
+    MatrixMultiplier<T>::Multiply(table_.data(), M, second.table_.data(), K,
+                                  res.table_.data(), K, N, M, K);
+  }
+
+  void MultiplyInto(const Matrix& second, Matrix& res, bool use_strassen,
+                    std::vector<T>& scratch) const {
+    if (!use_strassen) {
+      MultiplyInto(second, res);
+      return;
+    }
+    size_t leaf = N;
+    size_t levels = 0;
+    while (leaf > kStrassenThreshold) {
+      leaf = (leaf + 1) / 2;
+      ++levels;
+    }
+    size_t padded = leaf << levels;
+    size_t square = padded * padded;
+    if (scratch.empty()) {
+      size_t workspace = 0;
+      for (size_t half = padded / 2; half >= leaf && half != 0; half /= 2) {
+        workspace += 2 * half * half;
+      }
+      scratch.assign(3 * square + workspace, T());
+    }
+    T* first_pad = scratch.data();
+    T* second_pad = first_pad + square;
+    T* res_pad = second_pad + square;
+    for (size_t i = 0; i < N; ++i) {
+      std::copy(table_.begin() + i * N, table_.begin() + (i + 1) * N,
+                first_pad + i * padded);
+      std::copy(second.table_.begin() + i * N,
+                second.table_.begin() + (i + 1) * N, second_pad + i * padded);
+    }
+    StrassenBlocks(first_pad, padded, second_pad, padded, res_pad, padded,
+                   padded, leaf, res_pad + square);
+    for (size_t i = 0; i < N; ++i) {
+      std::copy(res_pad + i * padded, res_pad + i * padded + N,
+                res.table_.begin() + i * N);
+    }
+  }
+
+  static void AddBlocks(const T* first, size_t first_stride, const T* second,
+                        size_t second_stride, T* res, size_t res_stride,
+                        size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      for (size_t j = 0; j < size; ++j) {
+        res[i * res_stride + j] =
+            first[i * first_stride + j] + second[i * second_stride + j];
+      }
+    }
+  }
+
+  static void SubBlocks(const T* first, size_t first_stride, const T* second,
+                        size_t second_stride, T* res, size_t res_stride,
+                        size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      for (size_t j = 0; j < size; ++j) {
+        res[i * res_stride + j] =
+            first[i * first_stride + j] - second[i * second_stride + j];
+      }
+    }
+  }
+
+  // Strassen-Winograd product with the two-temporary schedule of Douglas et
+  // al.; workspace holds the temporaries of this and all deeper levels.
+  static void StrassenBlocks(const T* a, size_t sa, const T* b, size_t sb,
+                             T* c, size_t sc, size_t size, size_t leaf,
+                             T* workspace) {
+    if (size <= leaf) {
+      MatrixMultiplier<T>::Multiply(a, sa, b, sb, c, sc, size, size, size);
+      return;
+    }
+    size_t half = size / 2;
+    const T* a11 = a;
+    const T* a12 = a + half;
+    const T* a21 = a + half * sa;
+    const T* a22 = a21 + half;
+    const T* b11 = b;
+    const T* b12 = b + half;
+    const T* b21 = b + half * sb;
+    const T* b22 = b21 + half;
+    T* c11 = c;
+    T* c12 = c + half;
+    T* c21 = c + half * sc;
+    T* c22 = c21 + half;
+    T* x_tmp = workspace;
+    T* y_tmp = x_tmp + half * half;
+    T* deeper = y_tmp + half * half;
+
+    SubBlocks(a11, sa, a21, sa, x_tmp, half, half);
+    SubBlocks(b22, sb, b12, sb, y_tmp, half, half);
+    StrassenBlocks(x_tmp, half, y_tmp, half, c21, sc, half, leaf, deeper);
+    AddBlocks(a21, sa, a22, sa, x_tmp, half, half);
+    SubBlocks(b12, sb, b11, sb, y_tmp, half, half);
+    StrassenBlocks(x_tmp, half, y_tmp, half, c22, sc, half, leaf, deeper);
+    SubBlocks(x_tmp, half, a11, sa, x_tmp, half, half);
+    SubBlocks(b22, sb, y_tmp, half, y_tmp, half, half);
+    StrassenBlocks(x_tmp, half, y_tmp, half, c12, sc, half, leaf, deeper);
+    SubBlocks(a12, sa, x_tmp, half, x_tmp, half, half);
+    StrassenBlocks(x_tmp, half, b22, sb, c11, sc, half, leaf, deeper);
+    StrassenBlocks(a11, sa, b11, sb, x_tmp, half, half, leaf, deeper);
+    AddBlocks(x_tmp, half, c12, sc, c12, sc, half);
+    AddBlocks(c12, sc, c21, sc, c21, sc, half);
+    AddBlocks(c12, sc, c22, sc, c12, sc, half);
+    AddBlocks(c21, sc, c22, sc, c22, sc, half);
+    AddBlocks(c12, sc, c11, sc, c12, sc, half);
+    SubBlocks(y_tmp, half, b21, sb, y_tmp, half, half);
+    StrassenBlocks(a22, sa, y_tmp, half, c11, sc, half, leaf, deeper);
+    SubBlocks(c21, sc, c11, sc, c21, sc, half);
+    StrassenBlocks(a12, sa, b21, sb, c11, sc, half, leaf, deeper);
+    AddBlocks(x_tmp, half, c11, sc, c11, sc, half);
+  }
+
+  std::vector<T> table_;
 };
 
 template <size_t N, size_t M, typename T = int64_t>
@@ -114,4 +308,80 @@ Matrix<N, M, T> operator-(const Matrix<N, M, T>& first,
   Matrix<N, M, T> res = first;
   res -= second;
   return res;
-}
\ No newline at end of file
+}
+
+template <typename T>
+void CopyInto(typename MatrixSpan<T>::view_type source,
+              MatrixSpan<T> dest) {
+  for (size_t i = 0; i < dest.Rows(); ++i) {
+    for (size_t j = 0; j < dest.Cols(); ++j) {
+      dest(i, j) = source(i, j);
+    }
+  }
+}
+
+template <typename T>
+void AddInto(typename MatrixSpan<T>::view_type first,
+             typename MatrixSpan<T>::view_type second, MatrixSpan<T> res) {
+  for (size_t i = 0; i < res.Rows(); ++i) {
+    for (size_t j = 0; j < res.Cols(); ++j) {
+      res(i, j) = first(i, j) + second(i, j);
+    }
+  }
+}
+
+template <typename T>
+void SubtractInto(typename MatrixSpan<T>::view_type first,
+                  typename MatrixSpan<T>::view_type second, MatrixSpan<T> res) {
+  for (size_t i = 0; i < res.Rows(); ++i) {
+    for (size_t j = 0; j < res.Cols(); ++j) {
+      res(i, j) = first(i, j) - second(i, j);
+    }
+  }
+}
+
+template <typename T>
+const T* PackRows(MatrixView<T> view, std::vector<T>& buffer, size_t& stride) {
+  if (view.IsRowContiguous()) {
+    stride = static_cast<size_t>(view.RowStride());
+    return view.Data();
+  }
+  buffer.resize(view.Rows() * view.Cols());
+  stride = view.Cols();
+  CopyInto(view, MatrixSpan<T>(buffer.data(), view.Rows(), view.Cols()));
+  return buffer.data();
+}
+
+// res must not overlap first or second. Operands whose rows are not
+// contiguous are packed into a temporary before calling the kernel.
+template <typename T>
+void MultiplyInto(typename MatrixSpan<T>::view_type first,
+                  typename MatrixSpan<T>::view_type second, MatrixSpan<T> res) {
+  std::vector<T> first_buffer;
+  std::vector<T> second_buffer;
+  size_t first_stride = 0;
+  size_t second_stride = 0;
+  const T* first_data = PackRows(first, first_buffer, first_stride);
+  const T* second_data = PackRows(second, second_buffer, second_stride);
+  if (res.IsRowContiguous()) {
+    MatrixMultiplier<T>::Multiply(first_data, first_stride, second_data,
+                                  second_stride, res.Data(),
+                                  static_cast<size_t>(res.RowStride()),
+                                  res.Rows(), first.Cols(), res.Cols());
+    return;
+  }
+  std::vector<T> res_buffer(res.Rows() * res.Cols());
+  MatrixMultiplier<T>::Multiply(first_data, first_stride, second_data,
+                                second_stride, res_buffer.data(), res.Cols(),
+                                res.Rows(), first.Cols(), res.Cols());
+  CopyInto(MatrixView<T>(res_buffer.data(), res.Rows(), res.Cols()), res);
+}
+
+template <typename T, bool IsConst>
+T Trace(BaseMatrixView<T, IsConst> view) {
+  T res = T();
+  for (size_t i = 0; i < view.Rows() && i < view.Cols(); ++i) {
+    res += view(i, i);
+  }
+  return res;
+}
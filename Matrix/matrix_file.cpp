@@ -0,0 +1,80 @@
+#include "matrix_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <utility>
+
+void CheckMatrixFileHeader(const MatrixFileHeader& header,
+                           uint32_t element_type, uint64_t element_size) {
+  if (memcmp(header.magic, "MTRX", sizeof(header.magic)) != 0) {
+    throw std::runtime_error("not a matrix file");
+  }
+  if (header.version != kMatrixFileVersion) {
+    throw std::runtime_error("unsupported matrix file version");
+  }
+  if (header.byte_order != kMatrixFileByteOrder) {
+    throw std::runtime_error("matrix file has another byte order");
+  }
+  if (header.element_size != element_size ||
+      header.element_type != element_type) {
+    throw std::runtime_error("matrix file has another element type");
+  }
+  if (header.data_offset < sizeof(MatrixFileHeader) ||
+      header.data_offset % element_size != 0) {
+    throw std::runtime_error("matrix file has a misaligned payload");
+  }
+}
+
+MappedFile::MappedFile(const char* path) {
+  int descriptor = open(path, O_RDONLY);
+  if (descriptor == -1) {
+    throw std::runtime_error("cannot open matrix file");
+  }
+  struct stat info;
+  if (fstat(descriptor, &info) == -1) {
+    close(descriptor);
+    throw std::runtime_error("cannot stat matrix file");
+  }
+  size_ = static_cast<size_t>(info.st_size);
+  if (size_ != 0) {
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  }
+  close(descriptor);
+  if (data_ == MAP_FAILED) {
+    data_ = nullptr;
+    size_ = 0;
+    throw std::runtime_error("cannot map matrix file");
+  }
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+    : data_{other.data_}, size_{other.size_} {
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this != &other) {
+    Unmap();
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { Unmap(); }
+
+const char* MappedFile::Data() const { return static_cast<char*>(data_); }
+
+size_t MappedFile::Size() const { return size_; }
+
+void MappedFile::Unmap() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
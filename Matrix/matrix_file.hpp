@@ -0,0 +1,228 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include "matrix.hpp"
+
+const uint64_t kMatrixFileAlignment = 4096;
+const uint32_t kMatrixFileVersion = 1;
+const uint32_t kMatrixFileByteOrder = 0x01020304;
+
+struct MatrixFileHeader {
+  char magic[4] = {'M', 'T', 'R', 'X'};
+  uint32_t version = kMatrixFileVersion;
+  uint32_t byte_order = kMatrixFileByteOrder;
+  uint32_t element_type = 0;
+  uint64_t element_size = 0;
+  uint64_t rows = 0;
+  uint64_t cols = 0;
+  uint64_t data_offset = kMatrixFileAlignment;
+};
+
+template <typename T>
+struct MatrixElementType {
+  static const uint32_t kValue = 0;
+};
+
+template <>
+struct MatrixElementType<int32_t> {
+  static const uint32_t kValue = 1;
+};
+
+template <>
+struct MatrixElementType<int64_t> {
+  static const uint32_t kValue = 2;
+};
+
+template <>
+struct MatrixElementType<uint32_t> {
+  static const uint32_t kValue = 3;
+};
+
+template <>
+struct MatrixElementType<uint64_t> {
+  static const uint32_t kValue = 4;
+};
+
+template <>
+struct MatrixElementType<float> {
+  static const uint32_t kValue = 5;
+};
+
+template <>
+struct MatrixElementType<double> {
+  static const uint32_t kValue = 6;
+};
+
+void CheckMatrixFileHeader(const MatrixFileHeader& header,
+                           uint32_t element_type, uint64_t element_size);
+
+class MappedFile {
+ public:
+  explicit MappedFile(const char* path);
+
+  MappedFile(const MappedFile& other) = delete;
+
+  MappedFile(MappedFile&& other);
+
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  MappedFile& operator=(MappedFile&& other);
+
+  ~MappedFile();
+
+  const char* Data() const;
+
+  size_t Size() const;
+
+ private:
+  void Unmap();
+
+  void* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Read-only matrix backed by a memory-mapped file; pages are loaded lazily
+// by the kernel, so opening does not read the payload. T must be trivially
+// copyable.
+template <typename T>
+class MappedMatrix {
+ public:
+  explicit MappedMatrix(const char* path) : file_(path) {
+    if (file_.Size() < sizeof(MatrixFileHeader)) {
+      throw std::runtime_error("matrix file is too small");
+    }
+    memcpy(&header_, file_.Data(), sizeof(MatrixFileHeader));
+    CheckMatrixFileHeader(header_, MatrixElementType<T>::kValue, sizeof(T));
+    // The header is untrusted: a payload size that wraps around must not
+    // pass the comparison with the file size.
+    uint64_t payload_size;
+    if (__builtin_mul_overflow(header_.rows, header_.cols, &payload_size) ||
+        __builtin_mul_overflow(payload_size, sizeof(T), &payload_size) ||
+        header_.data_offset > file_.Size() ||
+        payload_size > file_.Size() - header_.data_offset) {
+      throw std::runtime_error("matrix file is truncated");
+    }
+  }
+
+  MatrixView<T> View() const {
+    return MatrixView<T>(
+        reinterpret_cast<const T*>(file_.Data() + header_.data_offset),
+        header_.rows, header_.cols);
+  }
+
+  const T& operator()(size_t i_num, size_t j_num) const {
+    return View()(i_num, j_num);
+  }
+
+  size_t Rows() const { return header_.rows; }
+
+  size_t Cols() const { return header_.cols; }
+
+  template <size_t N, size_t M>
+  Matrix<N, M, T> ToMatrix() const {
+    if (header_.rows != N || header_.cols != M) {
+      throw std::runtime_error("matrix file has another shape");
+    }
+    return Matrix<N, M, T>(View());
+  }
+
+ private:
+  MappedFile file_;
+  MatrixFileHeader header_;
+};
+
+// Writes the header up front and then streams rows, so a matrix never has
+// to be materialized in memory to be saved.
+template <typename T>
+class MatrixFileWriter {
+ public:
+  MatrixFileWriter(const char* path, size_t rows, size_t cols)
+      : stream_(path, std::ios::binary | std::ios::trunc) {
+    if (!stream_) {
+      throw std::runtime_error("cannot open matrix file for writing");
+    }
+    header_.element_type = MatrixElementType<T>::kValue;
+    header_.element_size = sizeof(T);
+    header_.rows = rows;
+    header_.cols = cols;
+    std::vector<char> prefix(header_.data_offset, '\0');
+    memcpy(prefix.data(), &header_, sizeof(MatrixFileHeader));
+    stream_.write(prefix.data(), prefix.size());
+  }
+
+  void WriteRow(const T* row) {
+    if (rows_written_ == header_.rows) {
+      throw std::out_of_range("too many rows for matrix file");
+    }
+    stream_.write(reinterpret_cast<const char*>(row),
+                  header_.cols * sizeof(T));
+    ++rows_written_;
+  }
+
+  void WriteRows(MatrixView<T> view) {
+    if (view.Cols() != header_.cols) {
+      throw std::runtime_error("matrix view has another number of columns");
+    }
+    if (view.IsRowContiguous() &&
+        view.RowStride() == static_cast<ptrdiff_t>(view.Cols())) {
+      if (rows_written_ + view.Rows() > header_.rows) {
+        throw std::out_of_range("too many rows for matrix file");
+      }
+      stream_.write(reinterpret_cast<const char*>(view.Data()),
+                    view.Rows() * view.Cols() * sizeof(T));
+      rows_written_ += view.Rows();
+      return;
+    }
+    std::vector<T> row(view.Cols());
+    for (size_t i = 0; i < view.Rows(); ++i) {
+      CopyInto(view.Row(i), MatrixSpan<T>(row.data(), 1, row.size()));
+      WriteRow(row.data());
+    }
+  }
+
+  void Close() {
+    if (rows_written_ != header_.rows) {
+      throw std::runtime_error("matrix file is incomplete");
+    }
+    stream_.close();
+    if (!stream_) {
+      throw std::runtime_error("cannot write matrix file");
+    }
+  }
+
+ private:
+  std::ofstream stream_;
+  MatrixFileHeader header_;
+  size_t rows_written_ = 0;
+};
+
+template <size_t N, size_t M, typename T>
+void WriteMatrix(const char* path, const Matrix<N, M, T>& matrix) {
+  MatrixFileWriter<T> writer(path, N, M);
+  writer.WriteRows(matrix.View());
+  writer.Close();
+}
+
+template <size_t N, size_t M, typename T = int64_t>
+Matrix<N, M, T> ReadMatrix(const char* path) {
+  std::ifstream stream(path, std::ios::binary);
+  MatrixFileHeader header;
+  if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    throw std::runtime_error("cannot read matrix file header");
+  }
+  CheckMatrixFileHeader(header, MatrixElementType<T>::kValue, sizeof(T));
+  if (header.rows != N || header.cols != M) {
+    throw std::runtime_error("matrix file has another shape");
+  }
+  Matrix<N, M, T> res;
+  stream.seekg(header.data_offset);
+  if (!stream.read(reinterpret_cast<char*>(res.Data()), N * M * sizeof(T))) {
+    throw std::runtime_error("matrix file is truncated");
+  }
+  return res;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+template <typename T, bool IsConst>
+class BaseMatrixView {
+ public:
+  using pointer = typename std::conditional<IsConst, const T*, T*>::type;
+  using reference = typename std::conditional<IsConst, const T&, T&>::type;
+  using view_type = BaseMatrixView<T, true>;
+
+  BaseMatrixView() {}
+
+  BaseMatrixView(pointer data, size_t rows, size_t cols)
+      : data_{data},
+        rows_{rows},
+        cols_{cols},
+        row_stride_{static_cast<ptrdiff_t>(cols)} {}
+
+  BaseMatrixView(pointer data, size_t rows, size_t cols, ptrdiff_t row_stride,
+                 ptrdiff_t col_stride)
+      : data_{data},
+        rows_{rows},
+        cols_{cols},
+        row_stride_{row_stride},
+        col_stride_{col_stride} {}
+
+  operator BaseMatrixView<T, true>() const {
+    return BaseMatrixView<T, true>(data_, rows_, cols_, row_stride_,
+                                   col_stride_);
+  }
+
+  reference operator()(size_t i_num, size_t j_num) const {
+    return data_[static_cast<ptrdiff_t>(i_num) * row_stride_ +
+                 static_cast<ptrdiff_t>(j_num) * col_stride_];
+  }
+
+  BaseMatrixView Block(size_t row, size_t col, size_t rows, size_t cols) const {
+    return BaseMatrixView(&operator()(row, col), rows, cols, row_stride_,
+                          col_stride_);
+  }
+
+  BaseMatrixView Row(size_t i_num) const { return Block(i_num, 0, 1, cols_); }
+
+  BaseMatrixView Column(size_t j_num) const {
+    return Block(0, j_num, rows_, 1);
+  }
+
+  BaseMatrixView Transposed() const {
+    return BaseMatrixView(data_, cols_, rows_, col_stride_, row_stride_);
+  }
+
+  bool IsRowContiguous() const { return col_stride_ == 1 && row_stride_ >= 0; }
+
+  pointer Data() const { return data_; }
+
+  size_t Rows() const { return rows_; }
+
+  size_t Cols() const { return cols_; }
+
+  ptrdiff_t RowStride() const { return row_stride_; }
+
+  ptrdiff_t ColumnStride() const { return col_stride_; }
+
+ private:
+  pointer data_ = nullptr;
+  size_t rows_ = 0;
+  size_t cols_ = 0;
+  ptrdiff_t row_stride_ = 0;
+  ptrdiff_t col_stride_ = 1;
+};
+
+template <typename T>
+using MatrixView = BaseMatrixView<T, true>;
+
+template <typename T>
+using MatrixSpan = BaseMatrixView<T, false>;
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "matrix.hpp"
+
+// P must be below 2^63 so that the sum of two residues fits into uint64_t.
+template <uint64_t P>
+class ModInt {
+ public:
+  ModInt() {}
+
+  ModInt(int64_t value) {
+    int64_t rem = value % static_cast<int64_t>(P);
+    value_ = static_cast<uint64_t>(rem < 0 ? rem + static_cast<int64_t>(P)
+                                           : rem);
+  }
+
+  static ModInt FromReduced(uint64_t value) {
+    ModInt res;
+    res.value_ = value;
+    return res;
+  }
+
+  static uint64_t Reduce(unsigned __int128 value) {
+    if ((value >> 64) == 0) {
+      uint64_t low = static_cast<uint64_t>(value);
+      uint64_t quotient = static_cast<uint64_t>(
+          (static_cast<unsigned __int128>(low) * kBarrettFactor) >> 64);
+      uint64_t rem = low - quotient * P;
+      while (rem >= P) {
+        rem -= P;
+      }
+      return rem;
+    }
+    return static_cast<uint64_t>(value % P);
+  }
+
+  // Number of products below P^2 that can be added to a reduced residue in
+  // an unsigned __int128 accumulator without overflow.
+  static uint64_t LazyTerms() {
+    unsigned __int128 square = static_cast<unsigned __int128>(P - 1) * (P - 1);
+    if (square == 0) {
+      return UINT64_MAX;
+    }
+    unsigned __int128 terms = (~static_cast<unsigned __int128>(0) - P) / square;
+    return terms > UINT64_MAX ? UINT64_MAX : static_cast<uint64_t>(terms);
+  }
+
+  uint64_t Value() const { return value_; }
+
+  ModInt& operator+=(const ModInt& other) {
+    value_ += other.value_;
+    if (value_ >= P) {
+      value_ -= P;
+    }
+    return *this;
+  }
+
+  ModInt& operator-=(const ModInt& other) {
+    value_ = value_ >= other.value_ ? value_ - other.value_
+                                    : value_ + P - other.value_;
+    return *this;
+  }
+
+  ModInt& operator*=(const ModInt& other) {
+    value_ = Reduce(static_cast<unsigned __int128>(value_) * other.value_);
+    return *this;
+  }
+
+  ModInt operator-() const { return FromReduced(value_ == 0 ? 0 : P - value_); }
+
+  ModInt Pow(uint64_t power) const {
+    ModInt res = FromReduced(1 % P);
+    ModInt base = *this;
+    while (power != 0) {
+      if ((power & 1) != 0) {
+        res *= base;
+      }
+      base *= base;
+      power >>= 1;
+    }
+    return res;
+  }
+
+  ModInt Inverse() const { return Pow(P - 2); }
+
+  bool operator==(const ModInt& other) const { return value_ == other.value_; }
+
+  bool operator!=(const ModInt& other) const { return value_ != other.value_; }
+
+ private:
+  static const uint64_t kBarrettFactor = UINT64_MAX / P;
+
+  uint64_t value_ = 0;
+};
+
+template <uint64_t P>
+ModInt<P> operator+(const ModInt<P>& first, const ModInt<P>& second) {
+  ModInt<P> res = first;
+  res += second;
+  return res;
+}
+
+template <uint64_t P>
+ModInt<P> operator-(const ModInt<P>& first, const ModInt<P>& second) {
+  ModInt<P> res = first;
+  res -= second;
+  return res;
+}
+
+template <uint64_t P>
+ModInt<P> operator*(const ModInt<P>& first, const ModInt<P>& second) {
+  ModInt<P> res = first;
+  res *= second;
+  return res;
+}
+
+template <uint64_t P>
+std::ostream& operator<<(std::ostream& os, const ModInt<P>& elem) {
+  return os << elem.Value();
+}
+
+template <uint64_t P>
+struct MatrixMultiplier<ModInt<P>> {
+  static void Multiply(const ModInt<P>* first, size_t first_stride,
+                       const ModInt<P>* second, size_t second_stride,
+                       ModInt<P>* res, size_t res_stride, size_t rows,
+                       size_t inner, size_t cols) {
+    uint64_t lazy_terms = ModInt<P>::LazyTerms();
+    std::vector<unsigned __int128> accumulator(cols);
+    for (size_t i = 0; i < rows; ++i) {
+      std::fill(accumulator.begin(), accumulator.end(), 0);
+      uint64_t pending = 0;
+      for (size_t t_num = 0; t_num < inner; ++t_num) {
+        uint64_t elem = first[i * first_stride + t_num].Value();
+        if (elem == 0) {
+          continue;
+        }
+        if (pending == lazy_terms) {
+          for (auto& sum : accumulator) {
+            sum = ModInt<P>::Reduce(sum);
+          }
+          pending = 0;
+        }
+        const ModInt<P>* second_row = second + t_num * second_stride;
+        for (size_t j = 0; j < cols; ++j) {
+          accumulator[j] +=
+              static_cast<unsigned __int128>(elem) * second_row[j].Value();
+        }
+        ++pending;
+      }
+      ModInt<P>* res_row = res + i * res_stride;
+      for (size_t j = 0; j < cols; ++j) {
+        res_row[j] = ModInt<P>::FromReduced(ModInt<P>::Reduce(accumulator[j]));
+      }
+    }
+  }
+};
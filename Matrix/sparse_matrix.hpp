@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "matrix.hpp"
+
+template <size_t N, size_t M, typename T>
+class CscMatrix;
+
+template <size_t N, size_t M, typename T = int64_t>
+class CsrMatrix {
+ public:
+  CsrMatrix() : row_offsets_(N + 1, 0) {}
+
+  CsrMatrix(const Matrix<N, M, T>& dense) : row_offsets_(N + 1, 0) {
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t j = 0; j < M; ++j) {
+        if (dense(i, j) != T()) {
+          values_.push_back(dense(i, j));
+          column_indices_.push_back(j);
+        }
+      }
+      row_offsets_[i + 1] = values_.size();
+    }
+  }
+
+  CsrMatrix(const CscMatrix<N, M, T>& other) : row_offsets_(N + 1, 0) {
+    const std::vector<size_t>& col_offsets = other.GetColumnOffsets();
+    const std::vector<size_t>& row_indices = other.GetRowIndices();
+    for (size_t row : row_indices) {
+      ++row_offsets_[row + 1];
+    }
+    for (size_t i = 0; i < N; ++i) {
+      row_offsets_[i + 1] += row_offsets_[i];
+    }
+    values_.resize(row_indices.size());
+    column_indices_.resize(row_indices.size());
+    std::vector<size_t> position(row_offsets_.begin(), row_offsets_.end() - 1);
+    for (size_t j = 0; j < M; ++j) {
+      for (size_t k = col_offsets[j]; k < col_offsets[j + 1]; ++k) {
+        size_t dest = position[row_indices[k]]++;
+        values_[dest] = other.GetValues()[k];
+        column_indices_[dest] = j;
+      }
+    }
+  }
+
+  Matrix<N, M, T> ToDense() const {
+    Matrix<N, M, T> res;
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t k = row_offsets_[i]; k < row_offsets_[i + 1]; ++k) {
+        res(i, column_indices_[k]) = values_[k];
+      }
+    }
+    return res;
+  }
+
+  std::vector<T> operator*(const std::vector<T>& vec) const {
+    std::vector<T> res(N);
+    MultiplyRows(vec, res, 0, N);
+    return res;
+  }
+
+  std::vector<T> MultiplyParallel(
+      const std::vector<T>& vec,
+      size_t threads_num = std::thread::hardware_concurrency()) const {
+    std::vector<T> res(N);
+    threads_num = std::max<size_t>(std::min(threads_num, N), 1);
+    std::vector<std::thread> threads;
+    threads.reserve(threads_num - 1);
+    size_t row_begin = 0;
+    for (size_t part = 1; part <= threads_num; ++part) {
+      size_t target = NonZeros() * part / threads_num;
+      size_t row_end = std::upper_bound(row_offsets_.begin() + row_begin,
+                                        row_offsets_.end() - 1, target) -
+                       row_offsets_.begin();
+      if (part == threads_num) {
+        row_end = N;
+        MultiplyRows(vec, res, row_begin, row_end);
+      } else {
+        threads.emplace_back([this, &vec, &res, row_begin, row_end] {
+          MultiplyRows(vec, res, row_begin, row_end);
+        });
+      }
+      row_begin = row_end;
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    return res;
+  }
+
+  template <size_t K>
+  Matrix<N, K, T> operator*(const Matrix<M, K, T>& dense) const {
+    Matrix<N, K, T> res;
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t k = row_offsets_[i]; k < row_offsets_[i + 1]; ++k) {
+        const T& elem = values_[k];
+        size_t t_num = column_indices_[k];
+        for (size_t j = 0; j < K; ++j) {
+          res(i, j) += elem * dense(t_num, j);
+        }
+      }
+    }
+    return res;
+  }
+
+  size_t NonZeros() const { return values_.size(); }
+
+  const std::vector<T>& GetValues() const { return values_; }
+
+  const std::vector<size_t>& GetColumnIndices() const {
+    return column_indices_;
+  }
+
+  const std::vector<size_t>& GetRowOffsets() const { return row_offsets_; }
+
+ private:
+  void MultiplyRows(const std::vector<T>& vec, std::vector<T>& res,
+                    size_t row_begin, size_t row_end) const {
+    for (size_t i = row_begin; i < row_end; ++i) {
+      T sum = T();
+      for (size_t k = row_offsets_[i]; k < row_offsets_[i + 1]; ++k) {
+        sum += values_[k] * vec[column_indices_[k]];
+      }
+      res[i] = sum;
+    }
+  }
+
+  std::vector<T> values_;
+  std::vector<size_t> column_indices_;
+  std::vector<size_t> row_offsets_;
+};
+
+template <size_t N, size_t M, typename T = int64_t>
+class CscMatrix {
+ public:
+  CscMatrix() : col_offsets_(M + 1, 0) {}
+
+  CscMatrix(const Matrix<N, M, T>& dense) : col_offsets_(M + 1, 0) {
+    for (size_t j = 0; j < M; ++j) {
+      for (size_t i = 0; i < N; ++i) {
+        if (dense(i, j) != T()) {
+          values_.push_back(dense(i, j));
+          row_indices_.push_back(i);
+        }
+      }
+      col_offsets_[j + 1] = values_.size();
+    }
+  }
+
+  CscMatrix(const CsrMatrix<N, M, T>& other) : col_offsets_(M + 1, 0) {
+    const std::vector<size_t>& row_offsets = other.GetRowOffsets();
+    const std::vector<size_t>& column_indices = other.GetColumnIndices();
+    for (size_t column : column_indices) {
+      ++col_offsets_[column + 1];
+    }
+    for (size_t j = 0; j < M; ++j) {
+      col_offsets_[j + 1] += col_offsets_[j];
+    }
+    values_.resize(column_indices.size());
+    row_indices_.resize(column_indices.size());
+    std::vector<size_t> position(col_offsets_.begin(), col_offsets_.end() - 1);
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t k = row_offsets[i]; k < row_offsets[i + 1]; ++k) {
+        size_t dest = position[column_indices[k]]++;
+        values_[dest] = other.GetValues()[k];
+        row_indices_[dest] = i;
+      }
+    }
+  }
+
+  Matrix<N, M, T> ToDense() const {
+    Matrix<N, M, T> res;
+    for (size_t j = 0; j < M; ++j) {
+      for (size_t k = col_offsets_[j]; k < col_offsets_[j + 1]; ++k) {
+        res(row_indices_[k], j) = values_[k];
+      }
+    }
+    return res;
+  }
+
+  std::vector<T> operator*(const std::vector<T>& vec) const {
+    std::vector<T> res(N);
+    for (size_t j = 0; j < M; ++j) {
+      const T& elem = vec[j];
+      for (size_t k = col_offsets_[j]; k < col_offsets_[j + 1]; ++k) {
+        res[row_indices_[k]] += values_[k] * elem;
+      }
+    }
+    return res;
+  }
+
+  size_t NonZeros() const { return values_.size(); }
+
+  const std::vector<T>& GetValues() const { return values_; }
+
+  const std::vector<size_t>& GetRowIndices() const { return row_indices_; }
+
+  const std::vector<size_t>& GetColumnOffsets() const { return col_offsets_; }
+
+ private:
+  std::vector<T> values_;
+  std::vector<size_t> row_indices_;
+  std::vector<size_t> col_offsets_;
+};
+
+template <size_t N, size_t M, size_t K, typename T>
+Matrix<N, K, T> operator*(const Matrix<N, M, T>& dense,
+                          const CscMatrix<M, K, T>& sparse) {
+  Matrix<N, K, T> res;
+  const std::vector<size_t>& col_offsets = sparse.GetColumnOffsets();
+  const std::vector<size_t>& row_indices = sparse.GetRowIndices();
+  const std::vector<T>& values = sparse.GetValues();
+  for (size_t j = 0; j < K; ++j) {
+    for (size_t k = col_offsets[j]; k < col_offsets[j + 1]; ++k) {
+      const T& elem = values[k];
+      size_t t_num = row_indices[k];
+      for (size_t i = 0; i < N; ++i) {
+        res(i, j) += dense(i, t_num) * elem;
+      }
+    }
+  }
+  return res;
+}
@@ -0,0 +1,138 @@
+#include "interned_string.hpp"
+
+#include <deque>
+#include <memory_resource>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+struct InternedString::Entry {
+  String text;
+  size_t hash;
+};
+
+// Splits the texts between independently locked shards picked by the high
+// bits of the hash. Lookups of texts that are already interned only take a
+// shared lock, so concurrent readers do not serialize.
+class InternTable {
+ public:
+  InternedString Intern(StringView text) {
+    size_t hash = Hash(text);
+    Shard& shard = shards_[hash >> (64 - kShardBits)];
+    {
+      std::shared_lock<std::shared_mutex> lock(shard.mutex);
+      const InternedString::Entry* entry = Find(shard, text, hash);
+      if (entry != nullptr) {
+        return InternedString(entry);
+      }
+    }
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    const InternedString::Entry* entry = Find(shard, text, hash);
+    if (entry == nullptr) {
+      entry = Insert(shard, text, hash);
+    }
+    return InternedString(entry);
+  }
+
+ private:
+  static const size_t kShardBits = 6;
+  static const size_t kInitialSlots = 64;
+
+  struct Shard {
+    std::shared_mutex mutex;
+    std::pmr::monotonic_buffer_resource arena;
+    std::deque<InternedString::Entry> entries;
+    std::vector<const InternedString::Entry*> slots =
+        std::vector<const InternedString::Entry*>(kInitialSlots);
+  };
+
+  static const InternedString::Entry* Find(const Shard& shard, StringView text,
+                                           size_t hash) {
+    size_t mask = shard.slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      const InternedString::Entry* entry = shard.slots[i];
+      if (entry == nullptr) {
+        return nullptr;
+      }
+      if (entry->hash == hash && StringView(entry->text) == text) {
+        return entry;
+      }
+    }
+  }
+
+  static void Place(std::vector<const InternedString::Entry*>& slots,
+                    const InternedString::Entry* entry) {
+    size_t mask = slots.size() - 1;
+    size_t i = entry->hash & mask;
+    while (slots[i] != nullptr) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = entry;
+  }
+
+  static const InternedString::Entry* Insert(Shard& shard, StringView text,
+                                             size_t hash) {
+    if ((shard.entries.size() + 1) * 2 > shard.slots.size()) {
+      std::vector<const InternedString::Entry*> slots(shard.slots.size() * 2);
+      for (const InternedString::Entry& entry : shard.entries) {
+        Place(slots, &entry);
+      }
+      shard.slots.swap(slots);
+    }
+    shard.entries.push_back({String(text, &shard.arena), hash});
+    const InternedString::Entry* entry = &shard.entries.back();
+    Place(shard.slots, entry);
+    return entry;
+  }
+
+  Shard shards_[size_t(1) << kShardBits];
+};
+
+// Never destroyed, so handles held by other static objects stay valid
+// during shutdown.
+static InternTable& GlobalInternTable() {
+  static InternTable* table = new InternTable;
+  return *table;
+}
+
+InternedString::InternedString() {}
+
+InternedString::InternedString(const Entry* entry) : entry_{entry} {}
+
+InternedString::InternedString(StringView text) {
+  if (!text.Empty()) {
+    entry_ = GlobalInternTable().Intern(text).entry_;
+  }
+}
+
+StringView InternedString::View() const {
+  return entry_ == nullptr ? StringView() : StringView(entry_->text);
+}
+
+InternedString::operator StringView() const { return View(); }
+
+const char* InternedString::Data() const { return View().Data(); }
+
+size_t InternedString::Size() const { return View().Size(); }
+
+bool InternedString::Empty() const { return entry_ == nullptr; }
+
+size_t InternedString::Hash() const {
+  return entry_ == nullptr ? ::Hash(StringView()) : entry_->hash;
+}
+
+bool InternedString::operator==(InternedString other) const {
+  return entry_ == other.entry_;
+}
+
+bool InternedString::operator!=(InternedString other) const {
+  return entry_ != other.entry_;
+}
+
+bool InternedString::operator<(InternedString other) const {
+  return entry_ != other.entry_ && View() < other.View();
+}
+
+std::ostream& operator<<(std::ostream& os, InternedString str) {
+  return os << str.View();
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <iostream>
+
+#include "string.hpp"
+
+// Handle to a String stored once in a process-wide interning table. Equal
+// texts always yield the same handle, so equality is a pointer compare and
+// duplicated keys share one copy of their symbols. Interned texts live
+// until the process exits.
+class InternedString {
+ public:
+  InternedString();
+
+  explicit InternedString(StringView text);
+
+  StringView View() const;
+
+  operator StringView() const;
+
+  const char* Data() const;
+
+  size_t Size() const;
+
+  bool Empty() const;
+
+  size_t Hash() const;
+
+  bool operator==(InternedString other) const;
+
+  bool operator!=(InternedString other) const;
+
+  // Lexicographic, so that ordered containers keep the order of the texts.
+  bool operator<(InternedString other) const;
+
+ private:
+  struct Entry;
+
+  explicit InternedString(const Entry* entry);
+
+  const Entry* entry_ = nullptr;
+
+  friend class InternTable;
+};
+
+std::ostream& operator<<(std::ostream& os, InternedString str);
@@ -0,0 +1,227 @@
+#include "rope.hpp"
+
+struct Rope::Node {
+  std::shared_ptr<const String> chunk;
+  size_t offset;
+  size_t length;
+  size_t size;
+  size_t count;
+  NodePtr left;
+  NodePtr right;
+};
+
+static uint64_t NextRandom() {
+  thread_local uint64_t state = 88172645463325252ull;
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+Rope::Rope() {}
+
+Rope::Rope(NodePtr root) : root_{std::move(root)} {}
+
+Rope::Rope(StringView text) : root_{Build(text)} {}
+
+size_t Rope::SizeOf(const NodePtr& node) {
+  return node == nullptr ? 0 : node->size;
+}
+
+size_t Rope::CountOf(const NodePtr& node) {
+  return node == nullptr ? 0 : node->count;
+}
+
+Rope::NodePtr Rope::MakeNode(const std::shared_ptr<const String>& chunk,
+                             size_t offset, size_t length, NodePtr left,
+                             NodePtr right) {
+  size_t size = SizeOf(left) + length + SizeOf(right);
+  size_t count = CountOf(left) + 1 + CountOf(right);
+  return std::make_shared<const Node>(Node{chunk, offset, length, size, count,
+                                           std::move(left),
+                                           std::move(right)});
+}
+
+Rope::NodePtr Rope::MakeLeaf(StringView text) {
+  return MakeNode(std::make_shared<const String>(text), 0, text.Size(),
+                  nullptr, nullptr);
+}
+
+// Puts the root of either side on top with probability proportional to the
+// number of nodes on that side. Unlike stored priorities, this keeps the
+// tree balanced when both sides share nodes, as in rope += rope.
+Rope::NodePtr Rope::Merge(const NodePtr& first, const NodePtr& second) {
+  if (first == nullptr) {
+    return second;
+  }
+  if (second == nullptr) {
+    return first;
+  }
+  if (NextRandom() % (first->count + second->count) < first->count) {
+    return MakeNode(first->chunk, first->offset, first->length, first->left,
+                    Merge(first->right, second));
+  }
+  return MakeNode(second->chunk, second->offset, second->length,
+                  Merge(first, second->left), second->right);
+}
+
+// Puts the first pos symbols of node into first and the rest into second.
+// A chunk crossing the border is shared by both halves instead of copied.
+void Rope::Split(const NodePtr& node, size_t pos, NodePtr& first,
+                 NodePtr& second) {
+  if (pos == 0) {
+    first = nullptr;
+    second = node;
+    return;
+  }
+  if (pos >= SizeOf(node)) {
+    first = node;
+    second = nullptr;
+    return;
+  }
+  size_t left_size = SizeOf(node->left);
+  if (pos <= left_size) {
+    NodePtr rest;
+    Split(node->left, pos, first, rest);
+    second = MakeNode(node->chunk, node->offset, node->length, rest,
+                      node->right);
+  } else if (pos >= left_size + node->length) {
+    NodePtr rest;
+    Split(node->right, pos - left_size - node->length, rest, second);
+    first = MakeNode(node->chunk, node->offset, node->length, node->left,
+                     rest);
+  } else {
+    size_t cut = pos - left_size;
+    first = MakeNode(node->chunk, node->offset, cut, node->left, nullptr);
+    second = MakeNode(node->chunk, node->offset + cut, node->length - cut,
+                      nullptr, node->right);
+  }
+}
+
+Rope::NodePtr Rope::Build(StringView text) {
+  NodePtr res;
+  for (size_t pos = 0; pos < text.Size(); pos += kMaxChunkSize) {
+    res = Merge(res, MakeLeaf(text.Substr(pos, kMaxChunkSize)));
+  }
+  return res;
+}
+
+void Rope::Flatten(const NodePtr& node, String& result) {
+  if (node == nullptr) {
+    return;
+  }
+  Flatten(node->left, result);
+  result.Append(node->chunk->Data() + node->offset, node->length);
+  Flatten(node->right, result);
+}
+
+void Rope::Print(const NodePtr& node, std::ostream& os) {
+  if (node == nullptr) {
+    return;
+  }
+  Print(node->left, os);
+  os.write(node->chunk->Data() + node->offset, node->length);
+  Print(node->right, os);
+}
+
+size_t Rope::Size() const { return SizeOf(root_); }
+
+bool Rope::Empty() const { return root_ == nullptr; }
+
+char Rope::operator[](size_t idx) const {
+  const Node* node = root_.get();
+  while (true) {
+    size_t left_size = SizeOf(node->left);
+    if (idx < left_size) {
+      node = node->left.get();
+    } else if (idx < left_size + node->length) {
+      return (*node->chunk)[node->offset + idx - left_size];
+    } else {
+      idx -= left_size + node->length;
+      node = node->right.get();
+    }
+  }
+}
+
+// Short appends are glued onto the last chunk while it stays below
+// kMaxChunkSize, so building a rope piece by piece does not leave a node
+// per piece.
+Rope& Rope::operator+=(StringView text) {
+  if (text.Empty()) {
+    return *this;
+  }
+  const Node* last = root_.get();
+  while (last != nullptr && last->right != nullptr) {
+    last = last->right.get();
+  }
+  if (last == nullptr || last->length + text.Size() > kMaxChunkSize) {
+    root_ = Merge(root_, Build(text));
+    return *this;
+  }
+  String joined(StringView(last->chunk->Data() + last->offset, last->length));
+  joined += text;
+  NodePtr rest;
+  NodePtr tail;
+  Split(root_, Size() - last->length, rest, tail);
+  root_ = Merge(rest, MakeLeaf(joined));
+  return *this;
+}
+
+Rope& Rope::operator+=(const Rope& other) {
+  root_ = Merge(root_, other.root_);
+  return *this;
+}
+
+void Rope::Insert(size_t pos, StringView text) { Insert(pos, Rope(text)); }
+
+void Rope::Insert(size_t pos, const Rope& other) {
+  NodePtr first;
+  NodePtr second;
+  Split(root_, pos, first, second);
+  root_ = Merge(Merge(first, other.root_), second);
+}
+
+void Rope::Erase(size_t pos, size_t count /*= kNpos*/) {
+  size_t size = Size();
+  if (pos >= size) {
+    return;
+  }
+  if (count > size - pos) {
+    count = size - pos;
+  }
+  NodePtr first;
+  NodePtr rest;
+  NodePtr middle;
+  NodePtr last;
+  Split(root_, pos, first, rest);
+  Split(rest, count, middle, last);
+  root_ = Merge(first, last);
+}
+
+Rope Rope::Substr(size_t pos, size_t count /*= kNpos*/) const {
+  NodePtr first;
+  NodePtr rest;
+  NodePtr middle;
+  NodePtr last;
+  Split(root_, pos, first, rest);
+  Split(rest, count, middle, last);
+  return Rope(middle);
+}
+
+String Rope::ToString() const {
+  String result;
+  result.Reserve(Size());
+  Flatten(root_, result);
+  return result;
+}
+
+Rope operator+(const Rope& first, const Rope& second) {
+  Rope result = first;
+  result += second;
+  return result;
+}
+
+std::ostream& operator<<(std::ostream& os, const Rope& rope) {
+  Rope::Print(rope.root_, os);
+  return os;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <memory>
+
+#include "string.hpp"
+
+// Text stored as a persistent implicit treap over slices of immutable String
+// chunks. Nodes are never modified after creation, so copies and Substr share
+// structure and every edit only rebuilds one root-to-leaf path.
+class Rope {
+ private:
+  struct Node;
+  using NodePtr = std::shared_ptr<const Node>;
+
+  static const size_t kMaxChunkSize = 512;
+
+  NodePtr root_;
+
+  explicit Rope(NodePtr root);
+
+  static size_t SizeOf(const NodePtr& node);
+  static size_t CountOf(const NodePtr& node);
+  static NodePtr MakeNode(const std::shared_ptr<const String>& chunk,
+                          size_t offset, size_t length, NodePtr left,
+                          NodePtr right);
+  static NodePtr MakeLeaf(StringView text);
+  static NodePtr Merge(const NodePtr& first, const NodePtr& second);
+  static void Split(const NodePtr& node, size_t pos, NodePtr& first,
+                    NodePtr& second);
+  static NodePtr Build(StringView text);
+  static void Flatten(const NodePtr& node, String& result);
+  static void Print(const NodePtr& node, std::ostream& os);
+
+ public:
+  Rope();
+
+  explicit Rope(StringView text);
+
+  size_t Size() const;
+
+  bool Empty() const;
+
+  char operator[](size_t idx) const;
+
+  Rope& operator+=(StringView text);
+
+  Rope& operator+=(const Rope& other);
+
+  void Insert(size_t pos, StringView text);
+
+  void Insert(size_t pos, const Rope& other);
+
+  void Erase(size_t pos, size_t count = kNpos);
+
+  Rope Substr(size_t pos, size_t count = kNpos) const;
+
+  String ToString() const;
+
+  friend std::ostream& operator<<(std::ostream& os, const Rope& rope);
+};
+
+Rope operator+(const Rope& first, const Rope& second);
+
+std::ostream& operator<<(std::ostream& os, const Rope& rope);
@@ -1,63 +1,524 @@
 #include "string.hpp"
 
-bool String::DoesMemAlloced() const { return static_cast<bool>(capacity_); }
-void String::Allocation() {
-  capacity_ = 1;
-  if (string_ == nullptr) {
-    char* buffer = new char[capacity_ + 1]{};
-    string_ = buffer;
+// Containers such as std::vector move elements on reallocation only when the
+// move constructor cannot throw; otherwise they copy.
+static_assert(std::is_nothrow_move_constructible<String>::value &&
+                  std::is_nothrow_move_assignable<String>::value,
+              "String moves must not throw");
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX2__)
+const size_t kSimdWidth = 32;
+#elif defined(__SSE2__)
+const size_t kSimdWidth = 16;
+#else
+const size_t kSimdWidth = 0;
+#endif
+
+// Bit k is set when text[k] equals first and text[k + last] equals
+// last_symbol, for kSimdWidth consecutive values of k.
+static uint32_t CandidateMask(const char* text, char first, char last_symbol,
+                              size_t last) {
+#if defined(__AVX2__)
+  __m256i first_block =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text));
+  __m256i last_block =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + last));
+  __m256i matches =
+      _mm256_and_si256(_mm256_cmpeq_epi8(first_block, _mm256_set1_epi8(first)),
+                       _mm256_cmpeq_epi8(last_block,
+                                         _mm256_set1_epi8(last_symbol)));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+#elif defined(__SSE2__)
+  __m128i first_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+  __m128i last_block =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + last));
+  __m128i matches =
+      _mm_and_si128(_mm_cmpeq_epi8(first_block, _mm_set1_epi8(first)),
+                    _mm_cmpeq_epi8(last_block, _mm_set1_epi8(last_symbol)));
+  return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+#else
+  (void)text;
+  (void)first;
+  (void)last_symbol;
+  (void)last;
+  return 0;
+#endif
+}
+
+static bool MatchesAt(const char* text, StringView pattern) {
+  return memcmp(text + 1, pattern.Data() + 1, pattern.Size() - 2) == 0;
+}
+
+static size_t FindSubstring(const char* text, size_t size, StringView pattern,
+                            size_t pos) {
+  size_t length = pattern.Size();
+  if (length > size || pos > size - length) {
+    return kNpos;
   }
+  if (length == 0) {
+    return pos;
+  }
+  if (length == 1) {
+    const void* found = memchr(text + pos, pattern[0], size - pos);
+    return found == nullptr ? kNpos : static_cast<const char*>(found) - text;
+  }
+  size_t last = length - 1;
+  char first = pattern[0];
+  char last_symbol = pattern[last];
+  size_t i = pos;
+  if (kSimdWidth != 0) {
+    for (; i + last + kSimdWidth <= size; i += kSimdWidth) {
+      uint32_t mask = CandidateMask(text + i, first, last_symbol, last);
+      while (mask != 0) {
+        size_t candidate = i + __builtin_ctz(mask);
+        if (MatchesAt(text + candidate, pattern)) {
+          return candidate;
+        }
+        mask &= mask - 1;
+      }
+    }
+  }
+  for (; i + last < size; ++i) {
+    if (text[i] == first && text[i + last] == last_symbol &&
+        MatchesAt(text + i, pattern)) {
+      return i;
+    }
+  }
+  return kNpos;
 }
-void String::Reallocation() {
-  capacity_ = size_ * 2;
-  char* buffer = new char[capacity_ + 1]{};
-  memcpy(buffer, string_, size_);
-  delete[] string_;
+
+static size_t RFindSubstring(const char* text, size_t size, StringView pattern,
+                             size_t pos) {
+  size_t length = pattern.Size();
+  if (length > size) {
+    return kNpos;
+  }
+  if (pos > size - length) {
+    pos = size - length;
+  }
+  if (length == 0) {
+    return pos;
+  }
+  size_t last = length - 1;
+  char first = pattern[0];
+  char last_symbol = pattern[last];
+  size_t end = pos + 1;
+  if (kSimdWidth != 0 && length > 1) {
+    for (; end >= kSimdWidth; end -= kSimdWidth) {
+      size_t block = end - kSimdWidth;
+      uint32_t mask = CandidateMask(text + block, first, last_symbol, last);
+      while (mask != 0) {
+        size_t bit = 31 - __builtin_clz(mask);
+        if (MatchesAt(text + block + bit, pattern)) {
+          return block + bit;
+        }
+        mask &= ~(uint32_t(1) << bit);
+      }
+    }
+  }
+  while (end != 0) {
+    --end;
+    if (text[end] == first && text[end + last] == last_symbol &&
+        (length == 1 || MatchesAt(text + end, pattern))) {
+      return end;
+    }
+  }
+  return kNpos;
+}
+
+static bool IsSpace(char symbol) {
+  return symbol == ' ' ||
+         static_cast<unsigned char>(symbol - '\t') <= '\r' - '\t';
+}
+
+// Index of the first whitespace symbol (as classified by isspace in the
+// "C" locale) in text, or size if there is none. stop is unused and only
+// keeps the signature shared with FindSymbol.
+static size_t FindSpace(const char* text, size_t size, char /*stop*/) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 32 <= size; i += 32) {
+    __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+    __m256i shifted = _mm256_sub_epi8(block, _mm256_set1_epi8('\t'));
+    __m256i control = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+    __m256i spaces = _mm256_or_si256(
+        control, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(' ')));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(spaces));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+#elif defined(__SSE2__)
+  for (; i + 16 <= size; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+    __m128i shifted = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+    __m128i control = _mm_cmpeq_epi8(
+        _mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+    __m128i spaces =
+        _mm_or_si128(control, _mm_cmpeq_epi8(block, _mm_set1_epi8(' ')));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(spaces));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+#endif
+  for (; i < size; ++i) {
+    if (IsSpace(text[i])) {
+      return i;
+    }
+  }
+  return size;
+}
+
+static size_t FindSymbol(const char* text, size_t size, char stop) {
+  const void* found = memchr(text, stop, size);
+  return found == nullptr ? size : static_cast<const char*>(found) - text;
+}
+
+// The get area of a stream buffer is protected, but a derived class may
+// form pointers to its accessors and apply them to any std::streambuf. This
+// lets extraction scan buffered bytes in place instead of pulling them out
+// one by one.
+struct StreamBufferAccess : std::streambuf {
+  static const char* Begin(std::streambuf* buffer) {
+    return (buffer->*&StreamBufferAccess::gptr)();
+  }
+
+  static const char* End(std::streambuf* buffer) {
+    return (buffer->*&StreamBufferAccess::egptr)();
+  }
+};
+
+StringView::StringView() {}
+
+StringView::StringView(const char* string)
+    : data_{string}, size_{strlen(string)} {}
+
+StringView::StringView(const char* data, size_t size)
+    : data_{data}, size_{size} {}
+
+const char& StringView::operator[](size_t idx) const { return data_[idx]; }
+
+const char* StringView::Data() const { return data_; }
+
+size_t StringView::Size() const { return size_; }
+
+bool StringView::Empty() const { return (size_ == 0); }
+
+StringView StringView::Substr(size_t pos, size_t count /*= kNpos*/) const {
+  if (pos > size_) {
+    pos = size_;
+  }
+  if (count > size_ - pos) {
+    count = size_ - pos;
+  }
+  return StringView(data_ + pos, count);
+}
+
+int StringView::Compare(StringView other) const {
+  size_t common = size_ < other.size_ ? size_ : other.size_;
+  int res = common == 0 ? 0 : memcmp(data_, other.data_, common);
+  if (res != 0) {
+    return res;
+  }
+  if (size_ == other.size_) {
+    return 0;
+  }
+  return size_ < other.size_ ? -1 : 1;
+}
+
+size_t StringView::Find(StringView pattern, size_t pos /*= 0*/) const {
+  return FindSubstring(data_, size_, pattern, pos);
+}
+
+size_t StringView::RFind(StringView pattern, size_t pos /*= kNpos*/) const {
+  return RFindSubstring(data_, size_, pattern, pos);
+}
+
+size_t StringView::FindFirstOf(StringView symbols, size_t pos /*= 0*/) const {
+  if (symbols.Size() == 1) {
+    return Find(symbols, pos);
+  }
+  bool is_symbol[256] = {};
+  for (size_t i = 0; i < symbols.Size(); ++i) {
+    is_symbol[static_cast<unsigned char>(symbols[i])] = true;
+  }
+  for (size_t i = pos; i < size_; ++i) {
+    if (is_symbol[static_cast<unsigned char>(data_[i])]) {
+      return i;
+    }
+  }
+  return kNpos;
+}
+
+size_t StringView::Count(StringView pattern) const {
+  if (pattern.Empty()) {
+    return size_ + 1;
+  }
+  size_t count = 0;
+  size_t pos = Find(pattern);
+  while (pos != kNpos) {
+    ++count;
+    pos = Find(pattern, pos + pattern.Size());
+  }
+  return count;
+}
+
+bool StringView::Contains(StringView pattern) const {
+  return Find(pattern) != kNpos;
+}
+
+bool StringView::ParseDouble(double& value) const {
+  const char* end = data_ + size_;
+  double parsed;
+  std::from_chars_result result = std::from_chars(data_, end, parsed);
+  if (result.ec != std::errc() || result.ptr != end) {
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+
+SubstringSearcher::SubstringSearcher(StringView pattern) : pattern_{pattern} {
+  if (pattern_.Size() < 2) {
+    return;
+  }
+  size_t last = pattern_.Size() - 1;
+  for (size_t& shift : shift_) {
+    shift = pattern_.Size();
+  }
+  for (size_t i = 0; i < last; ++i) {
+    shift_[static_cast<unsigned char>(pattern_[i])] = last - i;
+  }
+}
+
+const char* SubstringSearcher::Find(const char* begin, const char* end) const {
+  size_t length = pattern_.Size();
+  if (length == 0) {
+    return begin;
+  }
+  if (static_cast<size_t>(end - begin) < length) {
+    return end;
+  }
+  if (length == 1) {
+    const void* found = memchr(begin, pattern_[0], end - begin);
+    return found == nullptr ? end : static_cast<const char*>(found);
+  }
+  size_t last = length - 1;
+  char last_symbol = pattern_[last];
+  for (const char* pos = begin; pos <= end - length;
+       pos += shift_[static_cast<unsigned char>(pos[last])]) {
+    if (pos[last] == last_symbol && memcmp(pos, pattern_.Data(), last) == 0) {
+      return pos;
+    }
+  }
+  return end;
+}
+
+SplitView::iterator::iterator() {}
+
+SplitView::iterator::iterator(const SplitView* split, const char* piece_begin)
+    : split_{split}, piece_begin_{piece_begin} {
+  if (piece_begin_ != nullptr) {
+    piece_end_ = split_->FindDelim(piece_begin_);
+  }
+}
+
+StringView SplitView::iterator::operator*() const {
+  return StringView(piece_begin_, piece_end_ - piece_begin_);
+}
+
+SplitView::iterator& SplitView::iterator::operator++() {
+  const char* text_end = split_->text_.Data() + split_->text_.Size();
+  if (piece_end_ == text_end) {
+    piece_begin_ = nullptr;
+    piece_end_ = nullptr;
+  } else {
+    piece_begin_ = piece_end_ + split_->delim_.Size();
+    piece_end_ = split_->FindDelim(piece_begin_);
+  }
+  return *this;
+}
+
+SplitView::iterator SplitView::iterator::operator++(int) {
+  iterator copy = *this;
+  operator++();
+  return copy;
+}
+
+bool SplitView::iterator::operator==(const iterator& other) const {
+  return piece_begin_ == other.piece_begin_;
+}
+
+bool SplitView::iterator::operator!=(const iterator& other) const {
+  return !operator==(other);
+}
+
+SplitView::SplitView(StringView text, StringView delim)
+    : text_{text}, delim_{delim}, searcher_{delim} {}
+
+SplitView::iterator SplitView::begin() const {
+  return iterator(this, text_.Data());
+}
+
+SplitView::iterator SplitView::end() const { return iterator(this, nullptr); }
+
+const char* SplitView::FindDelim(const char* from) const {
+  const char* text_end = text_.Data() + text_.Size();
+  if (delim_.Empty()) {
+    return text_end;
+  }
+  return searcher_.Find(from, text_end);
+}
+
+bool String::IsShort() const { return string_ == short_buffer_; }
+
+char* String::Allocate(size_t capacity) {
+  return static_cast<char*>(resource_->allocate(capacity + 1, 1));
+}
+
+void String::Deallocate() {
+  if (!IsShort()) {
+    resource_->deallocate(string_, capacity_ + 1, 1);
+  }
+}
+
+void String::Reallocation(size_t new_cap) {
+  char* buffer = Allocate(new_cap);
+  memcpy(buffer, string_, size_ + 1);
+  Deallocate();
+  capacity_ = new_cap;
   string_ = buffer;
 }
 
+void String::Grow(size_t required) {
+  Reallocation(required > capacity_ * 2 ? required : capacity_ * 2);
+}
+
 bool String::DoesNeedReallocation() const { return (size_ == capacity_); }
 
+// Moves symbols from buffer into the string until find_stop reports a stop
+// symbol, which is consumed but not stored. Each run of buffered symbols is
+// scanned in place and copied with one sgetn. Returns false if the input
+// ended first.
+bool String::AppendFromStream(std::streambuf* buffer,
+                              size_t (*find_stop)(const char*, size_t, char),
+                              char stop) {
+  while (true) {
+    const char* begin = StreamBufferAccess::Begin(buffer);
+    const char* end = StreamBufferAccess::End(buffer);
+    if (begin == end) {
+      int symbol = buffer->sgetc();
+      if (symbol == EOF) {
+        return false;
+      }
+      begin = StreamBufferAccess::Begin(buffer);
+      end = StreamBufferAccess::End(buffer);
+      if (begin == end) {
+        char next = static_cast<char>(buffer->sbumpc());
+        if (find_stop(&next, 1, stop) == 0) {
+          return true;
+        }
+        PushBack(next);
+        continue;
+      }
+    }
+    size_t available = end - begin;
+    size_t count = find_stop(begin, available, stop);
+    if (count != 0) {
+      if (size_ + count > capacity_) {
+        Grow(size_ + count);
+      }
+      buffer->sgetn(string_ + size_, count);
+      size_ += count;
+      string_[size_] = '\0';
+    }
+    if (count < available) {
+      buffer->sbumpc();
+      return true;
+    }
+  }
+}
+
 String::String() {}
 
-String::String(const size_t& size, const char kCharacter)
-    : size_{size}, capacity_{size_}, string_{new char[capacity_ + 1]{}} {
+String::String(std::pmr::memory_resource* resource) : resource_{resource} {}
+
+String::String(const size_t& size, const char kCharacter) {
+  Reserve(size);
   memset(string_, kCharacter, size);
+  size_ = size;
+  string_[size_] = '\0';
 }
 
-String::String(const char* string)
-    : size_{strlen(string)},
-      capacity_{size_},
-      string_{new char[capacity_ + 1]{}} {
-  memcpy(string_, string, size_);
+String::String(const char* string) {
+  size_t length = strlen(string);
+  Reserve(length);
+  memcpy(string_, string, length + 1);
+  size_ = length;
 }
 
-String::String(const char kSymbol)
-    : capacity_{1}, string_{new char[capacity_ + 1]{}} {
+String::String(const char kSymbol) {
   if (kSymbol != '\0') {
     size_ = 1;
   }
   string_[0] = kSymbol;
 }
 
-String::String(const String& other)
-    : size_{other.size_},
-      capacity_{other.capacity_},
-      string_{new char[capacity_ + 1]{}} {
-  memcpy(string_, other.string_, size_);
+String::String(const String& other) {
+  Reserve(other.size_);
+  memcpy(string_, other.string_, other.size_);
+  size_ = other.size_;
+  string_[size_] = '\0';
+}
+
+String::String(String&& other) noexcept : resource_{other.resource_} {
+  if (other.IsShort()) {
+    memcpy(short_buffer_, other.short_buffer_, other.size_ + 1);
+  } else {
+    string_ = other.string_;
+    capacity_ = other.capacity_;
+    other.string_ = other.short_buffer_;
+    other.capacity_ = kShortCapacity;
+  }
+  size_ = other.size_;
+  other.size_ = 0;
+  other.string_[0] = '\0';
 }
 
+String::String(StringView view) { Append(view.Data(), view.Size()); }
+
+String::String(StringView view, std::pmr::memory_resource* resource)
+    : resource_{resource} {
+  Append(view.Data(), view.Size());
+}
+
+String::operator StringView() const { return StringView(string_, size_); }
+
 String& String::operator=(const String& str) {
-  Clear();
-  String intermidiate(str);
+  if (this != &str) {
+    Assign(str.string_, str.size_);
+  }
+  return *this;
+}
+
+String& String::operator=(String&& str) noexcept {
+  if (this == &str) {
+    return *this;
+  }
+  String intermidiate(std::move(str));
   this->Swap(intermidiate);
   return *this;
 }
 
 String& String::operator=(const char* string) {
-  Clear();
-  String intermidiate(string);
-  this->Swap(intermidiate);
+  Assign(string, strlen(string));
   return *this;
 }
 
@@ -66,30 +527,62 @@ String& String::operator=(const char kSymbol) {
   if (!(kSymbol == '\0')) {
     size_ = 1;
   }
-  capacity_ = 1;
-  Reserve(capacity_);
   string_[0] = kSymbol;
+  string_[size_] = '\0';
   return *this;
 }
 
-String::~String() { delete[] string_; }
+String::~String() { Deallocate(); }
+
 void String::Clear() {
-  if (DoesMemAlloced()) {
-    memset(string_, '\0', size_);
-    size_ = 0;
+  size_ = 0;
+  string_[0] = '\0';
+}
+
+String& String::Append(const char* data, size_t length) {
+  if (size_ + length > capacity_) {
+    size_t new_cap =
+        size_ + length > capacity_ * 2 ? size_ + length : capacity_ * 2;
+    char* buffer = Allocate(new_cap);
+    memcpy(buffer, string_, size_);
+    memcpy(buffer + size_, data, length);
+    Deallocate();
+    string_ = buffer;
+    capacity_ = new_cap;
+  } else {
+    memmove(string_ + size_, data, length);
   }
+  size_ += length;
+  string_[size_] = '\0';
+  return *this;
+}
+
+void String::Assign(const char* data, size_t length) {
+  if (length > capacity_) {
+    String intermidiate(resource_);
+    intermidiate.Reserve(length);
+    intermidiate.Append(data, length);
+    this->Swap(intermidiate);
+    return;
+  }
+  memmove(string_, data, length);
+  size_ = length;
+  string_[size_] = '\0';
+}
+
+void String::Prepend(const char* data, size_t length) {
+  memmove(string_ + length, string_, size_ + 1);
+  memcpy(string_, data, length);
+  size_ += length;
 }
 
 void String::PushBack(const char kCharacter) {
   if (DoesNeedReallocation()) {
-    if (DoesMemAlloced()) {
-      Reallocation();
-    } else {
-      Allocation();
-    }
+    Grow(size_ + 1);
   }
   string_[size_] = kCharacter;
   ++size_;
+  string_[size_] = '\0';
 }
 
 void String::PopBack() {
@@ -101,48 +594,54 @@ void String::PopBack() {
 
 void String::Resize(const size_t& new_size, const char kCharacter /*= '\0'*/) {
   if (new_size <= size_) {
-    if (DoesMemAlloced()) {
-      memset(string_ + new_size, kCharacter, size_ - new_size);
-    }
+    memset(string_ + new_size, kCharacter, size_ - new_size);
   } else {
     Reserve(new_size);
     memset(string_ + size_, kCharacter, new_size - size_);
   }
   size_ = new_size;
+  string_[size_] = '\0';
 }
 
 void String::Reserve(const size_t& new_cap) {
   if (new_cap > capacity_) {
-    if (!DoesMemAlloced()) {
-      Allocation();
-    }
-    capacity_ = new_cap;
-    char* buffer = new char[capacity_ + 1]{};
-    memcpy(buffer, string_, size_);
-    delete[] string_;
-    string_ = buffer;
+    Reallocation(new_cap);
   }
 }
 
 void String::ShrinkToFit() {
-  if (DoesMemAlloced()) {
-    if (capacity_ > size_) {
-      char* buffer = new char[size_ + 1];
-      buffer[size_] = '\0';
-      memcpy(buffer, string_, size_);
-      delete[] string_;
-      capacity_ = size_;
-      string_ = buffer;
-    }
+  if (IsShort() || capacity_ == size_) {
+    return;
   }
+  char* buffer = size_ <= kShortCapacity ? short_buffer_ : Allocate(size_);
+  memcpy(buffer, string_, size_);
+  buffer[size_] = '\0';
+  Deallocate();
+  capacity_ = buffer == short_buffer_ ? kShortCapacity : size_;
+  string_ = buffer;
 }
 
 void String::Swap(String& other) {
+  bool is_short = IsShort();
+  bool is_other_short = other.IsShort();
+  char buffer[kShortCapacity + 1];
+  memcpy(buffer, short_buffer_, sizeof(buffer));
+  memcpy(short_buffer_, other.short_buffer_, sizeof(buffer));
+  memcpy(other.short_buffer_, buffer, sizeof(buffer));
   std::swap(string_, other.string_);
+  if (is_other_short) {
+    string_ = short_buffer_;
+  }
+  if (is_short) {
+    other.string_ = other.short_buffer_;
+  }
   std::swap(size_, other.size_);
   std::swap(capacity_, other.capacity_);
+  std::swap(resource_, other.resource_);
 }
 
+std::pmr::memory_resource* String::GetResource() const { return resource_; }
+
 char& String::operator[](size_t idx) { return string_[idx]; }
 
 const char& String::operator[](size_t idx) const { return string_[idx]; }
@@ -166,85 +665,112 @@ char* String::Data() { return string_; }
 const char* String::Data() const { return string_; }
 
 String& String::operator+=(const String& other) {
-  if (!other.Empty()) {
-    Reserve(size_ + other.size_);
-    memcpy(string_ + size_, other.string_, other.size_);
-    size_ += other.size_;
-    return *this;
-  }
-  return *this;
+  return Append(other.string_, other.size_);
 }
 
 String& String::operator+=(const char* other) {
-  String buffer = other;
-  *this += buffer;
-  return *this;
+  return Append(other, strlen(other));
 }
 
 String& String::operator+=(const char kOther) {
-  String buffer = kOther;
-  *this += buffer;
+  if (kOther != '\0') {
+    PushBack(kOther);
+  }
   return *this;
 }
 
 String String::operator*(size_t n) const {
-  String res;
-  res.Reserve(size_ * n);
-  for (size_t i = 0; i < n; ++i) {
-    res += *this;
+  String res(resource_);
+  if (n == 0 || size_ == 0) {
+    return res;
+  }
+  size_t total_size = size_ * n;
+  res.Reserve(total_size);
+  memcpy(res.string_, string_, size_);
+  size_t filled = size_;
+  while (filled < total_size) {
+    size_t chunk =
+        filled < total_size - filled ? filled : total_size - filled;
+    memcpy(res.string_ + filled, res.string_, chunk);
+    filled += chunk;
   }
+  res.size_ = total_size;
+  res.string_[res.size_] = '\0';
   return res;
 }
 
-String String::operator*=(size_t n) const {
-  String res;
-  res.Reserve(size_ * n);
-  for (size_t i = 0; i < n; ++i) {
-    res += *this;
-  }
-  return res;
+String& String::operator*=(size_t n) {
+  String res = *this * n;
+  this->Swap(res);
+  return *this;
 }
 
-std::vector<String> String::Split(const String& delim /*= " "*/) {
-  std::vector<String> result_after_split = {};
-  result_after_split.resize(size_ / 2 + 1);
-  String buffer;
-  size_t iterator_for_vector = 0;
-  size_t i = 0;
-  while (i < size_ + 1) {
-    String intermidiate;
-    intermidiate.Reserve(delim.size_);
-    size_t j = 0;
-    for (; j < delim.size_; ++j) {
-      intermidiate += string_[i];
-      ++i;
-      if (!(string_[i - 1] == delim.string_[j])) {
-        buffer += intermidiate;
-        break;
-      }
-    }
-    if (j == delim.size_ || i == size_ + 1) {
-      if (buffer.Empty()) {
-        buffer.Allocation();
-        result_after_split[iterator_for_vector++].Swap(buffer);
-      } else {
-        result_after_split[iterator_for_vector++].Swap(buffer);
-      }
-    }
+std::vector<String> String::Split(StringView delim /*= " "*/) const {
+  std::vector<String> result_after_split;
+  for (StringView piece : SplitLazy(delim)) {
+    result_after_split.emplace_back(piece);
   }
-  result_after_split.resize(iterator_for_vector);
   return result_after_split;
 }
 
-String String::Join(const std::vector<String>& strings) const {
-  String result_after_join;
-  for (size_t i = 0; i < strings.size(); ++i) {
-    result_after_join += strings[i];
-    if (i != strings.size() - 1) {
-      result_after_join += *this;
+SplitView String::SplitLazy(StringView delim /*= " "*/) const {
+  return SplitView(*this, delim);
+}
+
+String& String::operator+=(StringView other) {
+  return Append(other.Data(), other.Size());
+}
+
+StringView String::Substr(size_t pos, size_t count /*= kNpos*/) const {
+  return StringView(*this).Substr(pos, count);
+}
+
+size_t String::Find(StringView pattern, size_t pos /*= 0*/) const {
+  return StringView(*this).Find(pattern, pos);
+}
+
+size_t String::RFind(StringView pattern, size_t pos /*= kNpos*/) const {
+  return StringView(*this).RFind(pattern, pos);
+}
+
+size_t String::FindFirstOf(StringView symbols, size_t pos /*= 0*/) const {
+  return StringView(*this).FindFirstOf(symbols, pos);
+}
+
+size_t String::Count(StringView pattern) const {
+  return StringView(*this).Count(pattern);
+}
+
+bool String::Contains(StringView pattern) const {
+  return StringView(*this).Contains(pattern);
+}
+
+String& String::AppendDouble(double value) {
+  const size_t kMaxLength = 32;
+  if (capacity_ - size_ >= kMaxLength) {
+    std::to_chars_result result =
+        std::to_chars(string_ + size_, string_ + capacity_, value);
+    if (result.ec == std::errc()) {
+      size_ = result.ptr - string_;
+      string_[size_] = '\0';
     }
+    return *this;
   }
-  return result_after_join;
+  char buffer[kMaxLength];
+  std::to_chars_result result =
+      std::to_chars(buffer, buffer + kMaxLength, value);
+  if (result.ec != std::errc()) {
+    return *this;
+  }
+  return Append(buffer, result.ptr - buffer);
+}
+
+bool String::ParseDouble(double& value) const {
+  return StringView(*this).ParseDouble(value);
+}
+
+String String::Join(const std::vector<String>& strings) const {
+  return Join<std::vector<String>>(strings);
 }
 
 std::ostream& operator<<(std::ostream& os, const String& str) {
@@ -254,48 +780,220 @@ std::ostream& operator<<(std::ostream& os, const String& str) {
   return os;
 }
 
+std::ostream& operator<<(std::ostream& os, StringView str) {
+  return os.write(str.Data(), str.Size());
+}
+
 std::istream& operator>>(std::istream& is, String& str) {
-  char buffer;
-  buffer = is.get();
-  while (buffer != EOF && isspace(buffer) == 0) {
-    str.PushBack(buffer);
-    buffer = is.get();
+  std::istream::sentry sentry(is, true);
+  if (!sentry) {
+    return is;
+  }
+  size_t old_size = str.size_;
+  if (!str.AppendFromStream(is.rdbuf(), FindSpace, ' ')) {
+    is.setstate(str.size_ == old_size
+                    ? std::ios_base::eofbit | std::ios_base::failbit
+                    : std::ios_base::eofbit);
   }
   return is;
 }
 
-bool operator<(const String& first, const String& second) {
-  if (first.Empty()) {
-    return !second.Empty();
+std::istream& ReadLine(std::istream& is, String& str, char delim) {
+  std::istream::sentry sentry(is, true);
+  if (!sentry) {
+    return is;
   }
-  if (second.Empty()) {
-    return false;
+  str.Clear();
+  if (!str.AppendFromStream(is.rdbuf(), FindSymbol, delim)) {
+    is.setstate(str.Empty() ? std::ios_base::eofbit | std::ios_base::failbit
+                            : std::ios_base::eofbit);
   }
-  return (strcmp(first.Data(), second.Data()) < 0);
+  return is;
 }
 
-bool operator>(const String& first, const String& second) {
-  return second < first;
+bool operator<(StringView first, StringView second) {
+  return first.Compare(second) < 0;
 }
 
-bool operator<=(const String& first, const String& second) {
+bool operator>(StringView first, StringView second) { return second < first; }
+
+bool operator<=(StringView first, StringView second) {
   return !(first > second);
 }
 
-bool operator>=(const String& first, const String& second) {
+bool operator>=(StringView first, StringView second) {
   return !(first < second);
 }
 
-bool operator==(const String& first, const String& second) {
-  return (first >= second) && (first <= second);
+bool operator==(StringView first, StringView second) {
+  return first.Size() == second.Size() &&
+         (first.Empty() ||
+          memcmp(first.Data(), second.Data(), first.Size()) == 0);
 }
 
-bool operator!=(const String& first, const String& second) {
+bool operator!=(StringView first, StringView second) {
   return !(first == second);
 }
 
+bool operator<(StringView first, char second) {
+  return first < StringView(&second, 1);
+}
+
+bool operator<(char first, StringView second) {
+  return StringView(&first, 1) < second;
+}
+
+bool operator>(StringView first, char second) {
+  return first > StringView(&second, 1);
+}
+
+bool operator>(char first, StringView second) {
+  return StringView(&first, 1) > second;
+}
+
+bool operator<=(StringView first, char second) {
+  return first <= StringView(&second, 1);
+}
+
+bool operator<=(char first, StringView second) {
+  return StringView(&first, 1) <= second;
+}
+
+bool operator>=(StringView first, char second) {
+  return first >= StringView(&second, 1);
+}
+
+bool operator>=(char first, StringView second) {
+  return StringView(&first, 1) >= second;
+}
+
+bool operator==(StringView first, char second) {
+  return first == StringView(&second, 1);
+}
+
+bool operator==(char first, StringView second) {
+  return StringView(&first, 1) == second;
+}
+
+bool operator!=(StringView first, char second) {
+  return first != StringView(&second, 1);
+}
+
+bool operator!=(char first, StringView second) {
+  return StringView(&first, 1) != second;
+}
+
+static const uint64_t kHashSecret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+    0x589965cc75374cc3ull};
+
+static uint64_t HashMix(uint64_t first, uint64_t second) {
+  unsigned __int128 product = static_cast<unsigned __int128>(first) * second;
+  return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+static uint64_t ReadWord(const char* data) {
+  uint64_t word;
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+static uint64_t ReadByte(const char* data) {
+  return static_cast<unsigned char>(*data);
+}
+
+static uint64_t ReadHalfWord(const char* data) {
+  uint32_t word;
+  memcpy(&word, data, sizeof(word));
+  return word;
+}
+
+// Long inputs run three independent multiply chains over 48-byte blocks so
+// that the multiplier stays busy; short ones are covered by overlapping
+// reads without a loop.
+size_t Hash(StringView text) {
+  const char* data = text.Data();
+  size_t size = text.Size();
+  uint64_t seed = HashMix(kHashSecret[0], kHashSecret[1]);
+  uint64_t first = 0;
+  uint64_t second = 0;
+  if (size <= 16) {
+    if (size >= 4) {
+      size_t shift = (size >> 3) << 2;
+      first = (ReadHalfWord(data) << 32) | ReadHalfWord(data + shift);
+      second = (ReadHalfWord(data + size - 4) << 32) |
+               ReadHalfWord(data + size - 4 - shift);
+    } else if (size > 0) {
+      first = (ReadByte(data) << 16) | (ReadByte(data + (size >> 1)) << 8) |
+              ReadByte(data + size - 1);
+    }
+  } else {
+    size_t rest = size;
+    if (rest > 48) {
+      uint64_t second_seed = seed;
+      uint64_t third_seed = seed;
+      do {
+        seed = HashMix(ReadWord(data) ^ kHashSecret[1],
+                       ReadWord(data + 8) ^ seed);
+        second_seed = HashMix(ReadWord(data + 16) ^ kHashSecret[2],
+                              ReadWord(data + 24) ^ second_seed);
+        third_seed = HashMix(ReadWord(data + 32) ^ kHashSecret[3],
+                             ReadWord(data + 40) ^ third_seed);
+        data += 48;
+        rest -= 48;
+      } while (rest > 48);
+      seed ^= second_seed ^ third_seed;
+    }
+    while (rest > 16) {
+      seed =
+          HashMix(ReadWord(data) ^ kHashSecret[1], ReadWord(data + 8) ^ seed);
+      data += 16;
+      rest -= 16;
+    }
+    first = ReadWord(data + rest - 16);
+    second = ReadWord(data + rest - 8);
+  }
+  unsigned __int128 product =
+      static_cast<unsigned __int128>(first ^ kHashSecret[1]) * (second ^ seed);
+  first = static_cast<uint64_t>(product);
+  second = static_cast<uint64_t>(product >> 64);
+  return HashMix(first ^ kHashSecret[0] ^ size, second ^ kHashSecret[1]);
+}
+
 String operator+(const String& first, const String& second) {
-  String result(first);
+  String result;
+  result.Reserve(first.Size() + second.Size());
+  result += first;
+  result += second;
+  return result;
+}
+
+String operator+(String&& first, const String& second) {
+  first += second;
+  return std::move(first);
+}
+
+String operator+(const String& first, String&& second) {
+  if (&first != &second &&
+      second.Capacity() >= first.Size() + second.Size()) {
+    second.Prepend(first.Data(), first.Size());
+    return std::move(second);
+  }
+  return first + static_cast<const String&>(second);
+}
+
+String operator+(StringView first, StringView second) {
+  String result;
+  result.Reserve(first.Size() + second.Size());
+  result += first;
   result += second;
   return result;
+}
+
+String operator+(String&& first, String&& second) {
+  if (first.Capacity() < first.Size() + second.Size() &&
+      second.Capacity() >= first.Size() + second.Size()) {
+    return static_cast<const String&>(first) + std::move(second);
+  }
+  return std::move(first) + static_cast<const String&>(second);
 }
\ No newline at end of file
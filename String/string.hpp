@@ -1,24 +1,146 @@
 #pragma once
 #include <string.h>
 
+#include <charconv>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 const size_t kBufferSize = 1000;
 
+const size_t kNpos = static_cast<size_t>(-1);
+
+class StringView {
+ public:
+  StringView();
+
+  StringView(const char* string);
+
+  StringView(const char* data, size_t size);
+
+  const char& operator[](size_t idx) const;
+
+  const char* Data() const;
+
+  size_t Size() const;
+
+  bool Empty() const;
+
+  StringView Substr(size_t pos, size_t count = kNpos) const;
+
+  int Compare(StringView other) const;
+
+  size_t Find(StringView pattern, size_t pos = 0) const;
+
+  size_t RFind(StringView pattern, size_t pos = kNpos) const;
+
+  size_t FindFirstOf(StringView symbols, size_t pos = 0) const;
+
+  size_t Count(StringView pattern) const;
+
+  bool Contains(StringView pattern) const;
+
+  // Succeed only if the whole view is a number that fits into value; value
+  // is left untouched otherwise. Leading whitespace and '+' are rejected.
+  template <typename Integer>
+  bool ParseInt(Integer& value, int base = 10) const;
+
+  bool ParseDouble(double& value) const;
+
+ private:
+  const char* data_ = "";
+  size_t size_ = 0;
+};
+
+// Boyer-Moore-Horspool matcher; single-character patterns go to memchr.
+class SubstringSearcher {
+ public:
+  explicit SubstringSearcher(StringView pattern);
+
+  const char* Find(const char* begin, const char* end) const;
+
+ private:
+  StringView pattern_;
+  size_t shift_[256];
+};
+
+// Lazily yields the pieces of text between occurrences of delim without
+// copying; both text and delim must outlive the SplitView.
+class SplitView {
+ public:
+  class iterator {
+   public:
+    using value_type = StringView;
+    using pointer = const StringView*;
+    using reference = StringView;
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+
+    iterator();
+
+    iterator(const SplitView* split, const char* piece_begin);
+
+    StringView operator*() const;
+
+    iterator& operator++();
+
+    iterator operator++(int);
+
+    bool operator==(const iterator& other) const;
+
+    bool operator!=(const iterator& other) const;
+
+   private:
+    const SplitView* split_ = nullptr;
+    const char* piece_begin_ = nullptr;
+    const char* piece_end_ = nullptr;
+  };
+
+  SplitView(StringView text, StringView delim);
+
+  iterator begin() const;
+
+  iterator end() const;
+
+ private:
+  const char* FindDelim(const char* from) const;
+
+  StringView text_;
+  StringView delim_;
+  SubstringSearcher searcher_;
+};
+
 class String {
  private:
+  static const size_t kShortCapacity = 15;
+
   size_t size_ = 0;
-  size_t capacity_ = 0;
-  char* string_ = nullptr;
-  bool DoesMemAlloced() const;
-  void Allocation();
-  void Reallocation();
+  size_t capacity_ = kShortCapacity;
+  char* string_ = short_buffer_;
+  char short_buffer_[kShortCapacity + 1] = {};
+  std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+  bool IsShort() const;
+  char* Allocate(size_t capacity);
+  void Deallocate();
+  void Reallocation(size_t new_cap);
+  void Grow(size_t required);
   bool DoesNeedReallocation() const;
+  void Assign(const char* data, size_t length);
+  void Prepend(const char* data, size_t length);
+  bool AppendFromStream(std::streambuf* buffer,
+                        size_t (*find_stop)(const char*, size_t, char),
+                        char stop);
 
  public:
   String();
 
+  explicit String(std::pmr::memory_resource* resource);
+
   String(const size_t& size, char character);
 
   String(const char* string);
@@ -27,8 +149,19 @@ class String {
 
   String(const String& other);
 
+  String(String&& other) noexcept;
+
+  explicit String(StringView view);
+
+  String(StringView view, std::pmr::memory_resource* resource);
+
+  operator StringView() const;
+
   String& operator=(const String& str);
 
+  // Takes the buffer together with its resource, so it never allocates.
+  String& operator=(String&& str) noexcept;
+
   String& operator=(const char* string);
 
   String& operator=(char symbol);
@@ -37,6 +170,8 @@ class String {
 
   void Clear();
 
+  String& Append(const char* data, size_t length);
+
   void PushBack(char character);
 
   void PopBack();
@@ -48,6 +183,9 @@ class String {
   void ShrinkToFit();
 
   void Swap(String& other);
+
+  std::pmr::memory_resource* GetResource() const;
+
   char& operator[](size_t idx);
 
   const char& operator[](size_t idx) const;
@@ -76,35 +214,208 @@ class String {
 
   String& operator+=(char other);
 
-  friend bool operator<(const String& first, const String& second);
+  String& operator+=(StringView other);
+
+  friend String operator+(const String& first, String&& second);
 
   friend std::ostream& operator<<(std::ostream& os, const String& str);
 
   friend std::istream& operator>>(std::istream& is, String& str);
 
+  friend std::istream& ReadLine(std::istream& is, String& str, char delim);
+
   String operator*(size_t n) const;
 
-  String operator*=(size_t n) const;
+  String& operator*=(size_t n);
 
-  std::vector<String> Split(const String& delim = " ");
+  std::vector<String> Split(StringView delim = " ") const;
+
+  SplitView SplitLazy(StringView delim = " ") const;
 
   String Join(const std::vector<String>& strings) const;
+
+  template <typename Container>
+  String Join(const Container& strings) const;
+
+  StringView Substr(size_t pos, size_t count = kNpos) const;
+
+  size_t Find(StringView pattern, size_t pos = 0) const;
+
+  size_t RFind(StringView pattern, size_t pos = kNpos) const;
+
+  size_t FindFirstOf(StringView symbols, size_t pos = 0) const;
+
+  size_t Count(StringView pattern) const;
+
+  bool Contains(StringView pattern) const;
+
+  template <typename Integer>
+  String& AppendInt(Integer value, int base = 10);
+
+  // Shortest representation that reads back as the same double.
+  String& AppendDouble(double value);
+
+  template <typename Integer>
+  bool ParseInt(Integer& value, int base = 10) const;
+
+  bool ParseDouble(double& value) const;
 };
 
 std::ostream& operator<<(std::ostream& os, const String& str);
 
+std::ostream& operator<<(std::ostream& os, StringView str);
+
 std::istream& operator>>(std::istream& is, String& str);
 
-bool operator<(const String& first, const String& second);
+// Replaces str with the symbols up to delim; delim is consumed but not
+// stored.
+std::istream& ReadLine(std::istream& is, String& str, char delim = '\n');
+
+bool operator<(StringView first, StringView second);
+
+bool operator>(StringView first, StringView second);
+
+bool operator<=(StringView first, StringView second);
 
-bool operator>(const String& first, const String& second);
+bool operator>=(StringView first, StringView second);
 
-bool operator<=(const String& first, const String& second);
+bool operator==(StringView first, StringView second);
 
-bool operator>=(const String& first, const String& second);
+bool operator!=(StringView first, StringView second);
 
-bool operator==(const String& first, const String& second);
+// A single symbol compares as a one-symbol string, as it did through the
+// implicit String(char) constructor.
+bool operator<(StringView first, char second);
+
+bool operator<(char first, StringView second);
+
+bool operator>(StringView first, char second);
+
+bool operator>(char first, StringView second);
 
-bool operator!=(const String& first, const String& second);
+bool operator<=(StringView first, char second);
+
+bool operator<=(char first, StringView second);
+
+bool operator>=(StringView first, char second);
+
+bool operator>=(char first, StringView second);
+
+bool operator==(StringView first, char second);
+
+bool operator==(char first, StringView second);
+
+bool operator!=(StringView first, char second);
+
+bool operator!=(char first, StringView second);
+
+// wyhash-style 64-bit hash of the symbols; equal texts hash equally no
+// matter whether they are held by a String or a StringView.
+size_t Hash(StringView text);
+
+String operator+(const String& first, const String& second);
+
+String operator+(String&& first, const String& second);
+
+String operator+(const String& first, String&& second);
+
+String operator+(String&& first, String&& second);
+
+String operator+(StringView first, StringView second);
+
+template <typename Integer>
+bool StringView::ParseInt(Integer& value, int base /*= 10*/) const {
+  const char* end = data_ + size_;
+  Integer parsed;
+  std::from_chars_result result = std::from_chars(data_, end, parsed, base);
+  if (result.ec != std::errc() || result.ptr != end) {
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+
+// Numbers are formatted straight into the spare capacity when it is large
+// enough for any value, and through a stack buffer otherwise, so that short
+// strings do not leave the inline buffer just to make room for the worst
+// case. Base 2 needs a digit per value bit plus the sign.
+template <typename Integer>
+String& String::AppendInt(Integer value, int base /*= 10*/) {
+  const size_t kMaxLength = std::numeric_limits<Integer>::digits +
+                            (std::is_signed<Integer>::value ? 2 : 1);
+  if (capacity_ - size_ >= kMaxLength) {
+    std::to_chars_result result =
+        std::to_chars(string_ + size_, string_ + capacity_, value, base);
+    if (result.ec == std::errc()) {
+      size_ = result.ptr - string_;
+      string_[size_] = '\0';
+    }
+    return *this;
+  }
+  char buffer[kMaxLength];
+  std::to_chars_result result =
+      std::to_chars(buffer, buffer + kMaxLength, value, base);
+  if (result.ec != std::errc()) {
+    return *this;
+  }
+  return Append(buffer, result.ptr - buffer);
+}
+
+template <typename Integer>
+bool String::ParseInt(Integer& value, int base /*= 10*/) const {
+  return StringView(*this).ParseInt(value, base);
+}
+
+template <typename Container>
+String String::Join(const Container& strings) const {
+  size_t total_size = 0;
+  size_t count = 0;
+  for (const auto& piece : strings) {
+    total_size += StringView(piece).Size();
+    ++count;
+  }
+  String result_after_join;
+  if (count == 0) {
+    return result_after_join;
+  }
+  result_after_join.Reserve(total_size + size_ * (count - 1));
+  bool is_first = true;
+  for (const auto& piece : strings) {
+    if (!is_first) {
+      result_after_join.Append(string_, size_);
+    }
+    StringView view(piece);
+    result_after_join.Append(view.Data(), view.Size());
+    is_first = false;
+  }
+  return result_after_join;
+}
+
+inline size_t ConcatSize(const String& piece) { return piece.Size(); }
+
+inline size_t ConcatSize(const char* piece) { return strlen(piece); }
+
+inline size_t ConcatSize(StringView piece) { return piece.Size(); }
+
+inline size_t ConcatSize(char /*piece*/) { return 1; }
+
+template <typename... Pieces>
+String Concat(const Pieces&... pieces) {
+  String result;
+  result.Reserve((ConcatSize(pieces) + ... + 0));
+  (result += ... += pieces);
+  return result;
+}
+namespace std {
+
+template <>
+struct hash<StringView> {
+  size_t operator()(StringView text) const { return Hash(text); }
+};
+
+template <>
+struct hash<String> {
+  size_t operator()(const String& str) const { return Hash(str); }
+};
 
-String operator+(const String& first, const String& second);
\ No newline at end of file
+}  // namespace std
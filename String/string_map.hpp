@@ -0,0 +1,262 @@
+#pragma once
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "string.hpp"
+
+// Open-addressing hash map keyed by String. Lookups take a StringView, so
+// probing never builds a temporary key, and callers that look the same key
+// up repeatedly can pass its Hash() once. Every slot keeps the full hash of
+// its key: probing compares hashes before symbols, and growing the table
+// never hashes a key again.
+template <typename V>
+class StringMap {
+ public:
+  // Iterators give read-only access to the key: a changed key would no
+  // longer match the hash its slot was chosen by.
+  class Entry {
+   public:
+    template <typename... Args>
+    explicit Entry(StringView key, Args&&... args)
+        : value(std::forward<Args>(args)...), key_(key) {}
+
+    const String& Key() const { return key_; }
+
+    V value;
+
+   private:
+    friend class StringMap;
+
+    String key_;
+  };
+
+ private:
+  static const size_t kOccupied = size_t(1) << 63;
+  static const size_t kInitialSlots = 16;
+
+  std::vector<size_t> hashes_;
+  std::vector<std::optional<Entry>> entries_;
+  size_t size_ = 0;
+
+  size_t Mask() const { return hashes_.size() - 1; }
+
+  size_t FindSlot(StringView key, size_t hash) const {
+    if (size_ == 0) {
+      return kNpos;
+    }
+    size_t tag = hash | kOccupied;
+    for (size_t i = hash & Mask();; i = (i + 1) & Mask()) {
+      if (hashes_[i] == 0) {
+        return kNpos;
+      }
+      if (hashes_[i] == tag && StringView(entries_[i]->key_) == key) {
+        return i;
+      }
+    }
+  }
+
+  size_t FreeSlot(size_t hash) const {
+    size_t i = hash & Mask();
+    while (hashes_[i] != 0) {
+      i = (i + 1) & Mask();
+    }
+    return i;
+  }
+
+  void Rehash(size_t slots) {
+    std::vector<size_t> old_hashes =
+        std::exchange(hashes_, std::vector<size_t>(slots, 0));
+    std::vector<std::optional<Entry>> old_entries =
+        std::exchange(entries_, std::vector<std::optional<Entry>>(slots));
+    for (size_t i = 0; i < old_hashes.size(); ++i) {
+      if (old_hashes[i] != 0) {
+        size_t slot = FreeSlot(old_hashes[i]);
+        hashes_[slot] = old_hashes[i];
+        entries_[slot] = std::move(old_entries[i]);
+      }
+    }
+  }
+
+  // Keeps the load factor at most 3/4.
+  void PrepareInsert() {
+    if (hashes_.empty()) {
+      Rehash(kInitialSlots);
+    } else if ((size_ + 1) * 4 > hashes_.size() * 3) {
+      Rehash(hashes_.size() * 2);
+    }
+  }
+
+  template <typename... Args>
+  size_t InsertNew(StringView key, size_t hash, Args&&... args) {
+    PrepareInsert();
+    size_t slot = FreeSlot(hash);
+    hashes_[slot] = hash | kOccupied;
+    entries_[slot].emplace(key, std::forward<Args>(args)...);
+    ++size_;
+    return slot;
+  }
+
+  template <bool IsConst>
+  class BaseIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+    using pointer =
+        typename std::conditional<IsConst, const Entry*, Entry*>::type;
+    using reference =
+        typename std::conditional<IsConst, const Entry&, Entry&>::type;
+    using map_pointer = typename std::conditional<IsConst, const StringMap*,
+                                                  StringMap*>::type;
+
+    BaseIterator(map_pointer map, size_t slot) : map_{map}, slot_{slot} {
+      SkipEmpty();
+    }
+
+    operator BaseIterator<true>() const {
+      return BaseIterator<true>(map_, slot_);
+    }
+
+    reference operator*() const { return *map_->entries_[slot_]; }
+
+    pointer operator->() const { return &*map_->entries_[slot_]; }
+
+    BaseIterator& operator++() {
+      ++slot_;
+      SkipEmpty();
+      return *this;
+    }
+
+    BaseIterator operator++(int) {
+      BaseIterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const BaseIterator& other) const {
+      return slot_ == other.slot_;
+    }
+
+    bool operator!=(const BaseIterator& other) const {
+      return slot_ != other.slot_;
+    }
+
+   private:
+    void SkipEmpty() {
+      while (slot_ < map_->hashes_.size() && map_->hashes_[slot_] == 0) {
+        ++slot_;
+      }
+    }
+
+    map_pointer map_;
+    size_t slot_;
+  };
+
+ public:
+  using iterator = BaseIterator<false>;
+  using const_iterator = BaseIterator<true>;
+
+  StringMap() {}
+
+  explicit StringMap(size_t count) { Reserve(count); }
+
+  size_t Size() const { return size_; }
+
+  bool Empty() const { return size_ == 0; }
+
+  V* Find(StringView key) { return Find(key, Hash(key)); }
+
+  const V* Find(StringView key) const { return Find(key, Hash(key)); }
+
+  // hash must be Hash(key).
+  V* Find(StringView key, size_t hash) {
+    size_t slot = FindSlot(key, hash);
+    return slot == kNpos ? nullptr : &entries_[slot]->value;
+  }
+
+  const V* Find(StringView key, size_t hash) const {
+    size_t slot = FindSlot(key, hash);
+    return slot == kNpos ? nullptr : &entries_[slot]->value;
+  }
+
+  bool Contains(StringView key) const { return Find(key) != nullptr; }
+
+  V& operator[](StringView key) {
+    size_t hash = Hash(key);
+    size_t slot = FindSlot(key, hash);
+    if (slot == kNpos) {
+      slot = InsertNew(key, hash);
+    }
+    return entries_[slot]->value;
+  }
+
+  // Leaves an existing value untouched; returns whether key was added.
+  template <typename... Args>
+  bool Emplace(StringView key, Args&&... args) {
+    size_t hash = Hash(key);
+    if (FindSlot(key, hash) != kNpos) {
+      return false;
+    }
+    InsertNew(key, hash, std::forward<Args>(args)...);
+    return true;
+  }
+
+  bool Insert(StringView key, const V& value) { return Emplace(key, value); }
+
+  bool Insert(StringView key, V&& value) {
+    return Emplace(key, std::move(value));
+  }
+
+  // Shifts the rest of the probe run back instead of leaving a tombstone,
+  // so erasures never lengthen later lookups.
+  bool Erase(StringView key) {
+    size_t slot = FindSlot(key, Hash(key));
+    if (slot == kNpos) {
+      return false;
+    }
+    hashes_[slot] = 0;
+    entries_[slot].reset();
+    --size_;
+    for (size_t next = (slot + 1) & Mask(); hashes_[next] != 0;
+         next = (next + 1) & Mask()) {
+      size_t home = hashes_[next] & Mask();
+      if (((next - home) & Mask()) >= ((next - slot) & Mask())) {
+        hashes_[slot] = hashes_[next];
+        entries_[slot] = std::move(entries_[next]);
+        hashes_[next] = 0;
+        entries_[next].reset();
+        slot = next;
+      }
+    }
+    return true;
+  }
+
+  void Reserve(size_t count) {
+    size_t slots = kInitialSlots;
+    while (count * 4 > slots * 3) {
+      slots *= 2;
+    }
+    if (slots > hashes_.size()) {
+      Rehash(slots);
+    }
+  }
+
+  void Clear() {
+    std::fill(hashes_.begin(), hashes_.end(), 0);
+    for (auto& entry : entries_) {
+      entry.reset();
+    }
+    size_ = 0;
+  }
+
+  iterator begin() { return iterator(this, 0); }
+
+  iterator end() { return iterator(this, hashes_.size()); }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+
+  const_iterator end() const { return const_iterator(this, hashes_.size()); }
+};
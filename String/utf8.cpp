@@ -0,0 +1,345 @@
+#include "utf8.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Decodes the sequence starting at text and returns its length, or 0 if it
+// is not valid UTF-8 (overlong forms, surrogates and values past U+10FFFF
+// included).
+static size_t DecodeCodePoint(const unsigned char* text, size_t size,
+                              char32_t& code_point) {
+  unsigned lead = text[0];
+  if (lead < 0x80) {
+    code_point = lead;
+    return 1;
+  }
+  if (lead < 0xC2 || lead > 0xF4) {
+    return 0;
+  }
+  size_t length = lead < 0xE0 ? 2 : (lead < 0xF0 ? 3 : 4);
+  if (size < length) {
+    return 0;
+  }
+  unsigned low = 0x80;
+  unsigned high = 0xBF;
+  if (lead == 0xE0) {
+    low = 0xA0;
+  } else if (lead == 0xED) {
+    high = 0x9F;
+  } else if (lead == 0xF0) {
+    low = 0x90;
+  } else if (lead == 0xF4) {
+    high = 0x8F;
+  }
+  if (text[1] < low || text[1] > high) {
+    return 0;
+  }
+  code_point = lead & (0x7F >> length);
+  for (size_t i = 1; i < length; ++i) {
+    if ((text[i] & 0xC0) != 0x80) {
+      return 0;
+    }
+    code_point = (code_point << 6) | (text[i] & 0x3F);
+  }
+  return length;
+}
+
+// Length of the ASCII prefix of text, found a word at a time.
+static size_t AsciiPrefix(const unsigned char* text, size_t size) {
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    memcpy(&word, text + i, sizeof(word));
+    if ((word & 0x8080808080808080ull) != 0) {
+      break;
+    }
+  }
+  while (i < size && text[i] < 0x80) {
+    ++i;
+  }
+  return i;
+}
+
+#if defined(__AVX2__)
+// Lookup-table validation of Keiser and Lemire ("Validating UTF-8 In Less
+// Than One Instruction Per Byte"). Each byte is classified together with
+// the one before it by three 16-entry nibble tables; a zero AND of the
+// three lookups means the pair is legal. Lengths of 3- and 4-byte sequences
+// are checked separately against the bytes two and three positions back.
+namespace {
+
+const uint8_t kTooShort = 1 << 0;
+const uint8_t kTooLong = 1 << 1;
+const uint8_t kOverlong3 = 1 << 2;
+const uint8_t kTooLarge = 1 << 3;
+const uint8_t kSurrogate = 1 << 4;
+const uint8_t kOverlong2 = 1 << 5;
+const uint8_t kTooLarge1000 = 1 << 6;
+const uint8_t kOverlong4 = 1 << 6;
+const uint8_t kTwoConts = 1 << 7;
+const uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+__m256i Table(uint8_t v0, uint8_t v1, uint8_t v2, uint8_t v3, uint8_t v4,
+              uint8_t v5, uint8_t v6, uint8_t v7, uint8_t v8, uint8_t v9,
+              uint8_t v10, uint8_t v11, uint8_t v12, uint8_t v13, uint8_t v14,
+              uint8_t v15) {
+  return _mm256_setr_epi8(v0, v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11,
+                          v12, v13, v14, v15, v0, v1, v2, v3, v4, v5, v6, v7,
+                          v8, v9, v10, v11, v12, v13, v14, v15);
+}
+
+__m256i HighNibble(__m256i input) {
+  return _mm256_and_si256(_mm256_srli_epi16(input, 4), _mm256_set1_epi8(0x0F));
+}
+
+// Bytes of input shifted right by Count positions, with the last Count
+// bytes of previous shifted in.
+template <int Count>
+__m256i Previous(__m256i input, __m256i previous) {
+  return _mm256_alignr_epi8(
+      input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - Count);
+}
+
+__m256i SpecialCases(__m256i input, __m256i previous1) {
+  __m256i byte1_high = _mm256_shuffle_epi8(
+      Table(kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+            kTooLong, kTooLong, kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+            kTooShort | kOverlong2, kTooShort,
+            kTooShort | kOverlong3 | kSurrogate,
+            kTooShort | kTooLarge | kTooLarge1000 | kOverlong4),
+      HighNibble(previous1));
+  const uint8_t kLarge = kCarry | kTooLarge | kTooLarge1000;
+  __m256i byte1_low = _mm256_shuffle_epi8(
+      Table(kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+            kCarry | kOverlong2, kCarry, kCarry, kCarry | kTooLarge, kLarge,
+            kLarge, kLarge, kLarge, kLarge, kLarge, kLarge, kLarge,
+            kLarge | kSurrogate, kLarge, kLarge),
+      _mm256_and_si256(previous1, _mm256_set1_epi8(0x0F)));
+  const uint8_t kContinuation = kTooLong | kOverlong2 | kTwoConts;
+  __m256i byte2_high = _mm256_shuffle_epi8(
+      Table(kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+            kTooShort, kTooShort,
+            kContinuation | kOverlong3 | kTooLarge1000 | kOverlong4,
+            kContinuation | kOverlong3 | kTooLarge,
+            kContinuation | kSurrogate | kTooLarge,
+            kContinuation | kSurrogate | kTooLarge, kTooShort, kTooShort,
+            kTooShort, kTooShort),
+      HighNibble(input));
+  return _mm256_and_si256(_mm256_and_si256(byte1_high, byte1_low),
+                          byte2_high);
+}
+
+__m256i BlockErrors(__m256i input, __m256i previous) {
+  __m256i special = SpecialCases(input, Previous<1>(input, previous));
+  __m256i third = _mm256_subs_epu8(Previous<2>(input, previous),
+                                   _mm256_set1_epi8(char(0xE0 - 0x80)));
+  __m256i fourth = _mm256_subs_epu8(Previous<3>(input, previous),
+                                    _mm256_set1_epi8(char(0xF0 - 0x80)));
+  __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                           _mm256_set1_epi8(char(0x80)));
+  return _mm256_xor_si256(must_continue, special);
+}
+
+// Non-zero where the block ends inside a multi-byte sequence.
+__m256i Incomplete(__m256i input) {
+  __m256i limits = _mm256_setr_epi8(
+      char(255), char(255), char(255), char(255), char(255), char(255),
+      char(255), char(255), char(255), char(255), char(255), char(255),
+      char(255), char(255), char(255), char(255), char(255), char(255),
+      char(255), char(255), char(255), char(255), char(255), char(255),
+      char(255), char(255), char(255), char(255), char(255), char(0xF0 - 1),
+      char(0xE0 - 1), char(0xC0 - 1));
+  return _mm256_subs_epu8(input, limits);
+}
+
+}  // namespace
+
+bool IsValidUtf8(StringView text) {
+  const char* data = text.Data();
+  size_t size = text.Size();
+  __m256i error = _mm256_setzero_si256();
+  __m256i previous = _mm256_setzero_si256();
+  __m256i previous_incomplete = _mm256_setzero_si256();
+  char tail[32] = {};
+  for (size_t i = 0; i < size; i += 32) {
+    __m256i input;
+    if (i + 32 <= size) {
+      input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    } else {
+      memcpy(tail, data + i, size - i);
+      input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail));
+    }
+    if (_mm256_movemask_epi8(input) == 0) {
+      error = _mm256_or_si256(error, previous_incomplete);
+      continue;
+    }
+    error = _mm256_or_si256(error, BlockErrors(input, previous));
+    previous_incomplete = Incomplete(input);
+    previous = input;
+  }
+  error = _mm256_or_si256(error, previous_incomplete);
+  return _mm256_testz_si256(error, error) != 0;
+}
+#else
+bool IsValidUtf8(StringView text) {
+  const unsigned char* data =
+      reinterpret_cast<const unsigned char*>(text.Data());
+  size_t size = text.Size();
+  size_t i = 0;
+  while (i < size) {
+    i += AsciiPrefix(data + i, size - i);
+    if (i == size) {
+      break;
+    }
+    char32_t code_point;
+    size_t length = DecodeCodePoint(data + i, size - i, code_point);
+    if (length == 0) {
+      return false;
+    }
+    i += length;
+  }
+  return true;
+}
+#endif
+
+// Counts the bytes that are not continuation bytes (10xxxxxx).
+size_t CountCodePoints(StringView text) {
+  const char* data = text.Data();
+  size_t size = text.Size();
+  size_t count = 0;
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 32 <= size; i += 32) {
+    __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    count += __builtin_popcount(static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpgt_epi8(block, _mm256_set1_epi8(-65)))));
+  }
+#elif defined(__SSE2__)
+  for (; i + 16 <= size; i += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    count += __builtin_popcount(static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpgt_epi8(block, _mm_set1_epi8(-65)))));
+  }
+#endif
+  for (; i < size; ++i) {
+    count += static_cast<signed char>(data[i]) > -65 ? 1 : 0;
+  }
+  return count;
+}
+
+// Widens runs of ASCII bytes 16 at a time and decodes everything else one
+// sequence at a time, validating as it goes.
+template <typename Unit>
+static size_t Transcode(StringView text, Unit* out) {
+  const unsigned char* data =
+      reinterpret_cast<const unsigned char*>(text.Data());
+  size_t size = text.Size();
+  Unit* begin = out;
+  size_t i = 0;
+  while (i < size) {
+#if defined(__SSE2__)
+    for (; i + 16 <= size; i += 16, out += 16) {
+      __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+      if (_mm_movemask_epi8(block) != 0) {
+        break;
+      }
+      __m128i zero = _mm_setzero_si128();
+      __m128i low = _mm_unpacklo_epi8(block, zero);
+      __m128i high = _mm_unpackhi_epi8(block, zero);
+      if (sizeof(Unit) == 2) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), high);
+      } else {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                         _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4),
+                         _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8),
+                         _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12),
+                         _mm_unpackhi_epi16(high, zero));
+      }
+    }
+#endif
+    size_t ascii_end = i + AsciiPrefix(data + i, size - i);
+    for (; i < ascii_end; ++i) {
+      *out++ = data[i];
+    }
+    if (i == size) {
+      break;
+    }
+    char32_t code_point;
+    size_t length = DecodeCodePoint(data + i, size - i, code_point);
+    if (length == 0) {
+      return kNpos;
+    }
+    i += length;
+    if (sizeof(Unit) == 2 && code_point > 0xFFFF) {
+      code_point -= 0x10000;
+      *out++ = static_cast<Unit>(0xD800 + (code_point >> 10));
+      *out++ = static_cast<Unit>(0xDC00 + (code_point & 0x3FF));
+    } else {
+      *out++ = static_cast<Unit>(code_point);
+    }
+  }
+  return out - begin;
+}
+
+size_t ToUtf16(StringView text, char16_t* out) { return Transcode(text, out); }
+
+size_t ToUtf32(StringView text, char32_t* out) { return Transcode(text, out); }
+
+CodePointView::Iterator::Iterator(const char* current, const char* end)
+    : current_{current}, end_{end} {
+  Decode();
+}
+
+void CodePointView::Iterator::Decode() {
+  if (current_ == end_) {
+    length_ = 0;
+    return;
+  }
+  length_ = DecodeCodePoint(reinterpret_cast<const unsigned char*>(current_),
+                            end_ - current_, code_point_);
+  if (length_ == 0) {
+    length_ = 1;
+    code_point_ = kReplacementCharacter;
+  }
+}
+
+char32_t CodePointView::Iterator::operator*() const { return code_point_; }
+
+CodePointView::Iterator& CodePointView::Iterator::operator++() {
+  current_ += length_;
+  Decode();
+  return *this;
+}
+
+CodePointView::Iterator CodePointView::Iterator::operator++(int) {
+  Iterator copy = *this;
+  ++*this;
+  return copy;
+}
+
+bool CodePointView::Iterator::operator==(const Iterator& other) const {
+  return current_ == other.current_;
+}
+
+bool CodePointView::Iterator::operator!=(const Iterator& other) const {
+  return current_ != other.current_;
+}
+
+const char* CodePointView::Iterator::Data() const { return current_; }
+
+CodePointView::CodePointView(StringView text) : text_{text} {}
+
+CodePointView::Iterator CodePointView::begin() const {
+  return Iterator(text_.Data(), text_.Data() + text_.Size());
+}
+
+CodePointView::Iterator CodePointView::end() const {
+  return Iterator(text_.Data() + text_.Size(), text_.Data() + text_.Size());
+}
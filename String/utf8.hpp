@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <iterator>
+
+#include "string.hpp"
+
+bool IsValidUtf8(StringView text);
+
+// Number of code points in text, which must be valid UTF-8.
+size_t CountCodePoints(StringView text);
+
+// Write the code points of text into out, which must have room for
+// text.Size() units. Return the number of units written, or kNpos if text is
+// not valid UTF-8.
+size_t ToUtf16(StringView text, char16_t* out);
+
+size_t ToUtf32(StringView text, char32_t* out);
+
+const char32_t kReplacementCharacter = 0xFFFD;
+
+// Forward range over the code points of UTF-8 text. A byte that does not
+// start a valid sequence yields kReplacementCharacter and is skipped alone.
+// Non-owning, like StringView.
+class CodePointView {
+ public:
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = char32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const char32_t*;
+    using reference = char32_t;
+
+    Iterator(const char* current, const char* end);
+
+    char32_t operator*() const;
+
+    Iterator& operator++();
+
+    Iterator operator++(int);
+
+    bool operator==(const Iterator& other) const;
+
+    bool operator!=(const Iterator& other) const;
+
+    // Position of the current code point in the underlying text.
+    const char* Data() const;
+
+   private:
+    void Decode();
+
+    const char* current_;
+    const char* end_;
+    size_t length_ = 0;
+    char32_t code_point_ = 0;
+  };
+
+  explicit CodePointView(StringView text);
+
+  Iterator begin() const;
+
+  Iterator end() const;
+
+ private:
+  StringView text_;
+};